@@ -101,6 +101,33 @@ public:
             memberIdx = (memberIdx + 1) % members.size();
         });
     }
+
+    void Bench_VerifyAndAggregateContributions(benchmark::Bench &bench, int invalidCount, uint32_t epoch_iters) {
+        ReceiveVvecs();
+        size_t memberIdx = 0;
+        bench.minEpochIterations(epoch_iters).run([&] {
+            ReceiveShares(memberIdx);
+
+            std::set <size_t> invalidIndexes;
+            for (int i = 0; i < invalidCount; i++) {
+                int shareIdx = GetRandInt(receivedSkShares.size());
+                receivedSkShares[shareIdx].MakeNewKey();
+                invalidIndexes.emplace(shareIdx);
+            }
+
+            std::vector<bool> valid;
+            BLSVerificationVectorPtr vvec;
+            CBLSSecretKey skShare;
+            bool ok = blsWorker.VerifyAndAggregateContributions(members[memberIdx].id, receivedVvecs, receivedSkShares,
+                                                                valid, vvec, skShare);
+            assert(ok && vvec != nullptr && skShare.IsValid());
+            for (size_t i = 0; i < receivedVvecs.size(); i++) {
+                assert(valid[i] == !invalidIndexes.count(i));
+            }
+
+            memberIdx = (memberIdx + 1) % members.size();
+        });
+    }
 };
 
 static void BLSDKG_GenerateContributions(benchmark::Bench &bench, uint32_t epoch_iters, int quorumSize) {
@@ -161,6 +188,15 @@ static void BLSDKG_InitDKG(benchmark::Bench &bench, uint32_t epoch_iters, int qu
     } \
     BENCHMARK(BLSDKG_VerifyContributionShares_##name##_##quorumSize)
 
+#define BENCH_VerifyAndAggregateContributions(name, quorumSize, invalidCount, epoch_iters) \
+    static void BLSDKG_VerifyAndAggregateContributions_##name##_##quorumSize(benchmark::Bench& bench) \
+    { \
+        std::unique_ptr<DKG> ptr = std::make_unique<DKG>(quorumSize); \
+        ptr->Bench_VerifyAndAggregateContributions(bench, invalidCount, epoch_iters); \
+        ptr.reset(); \
+    } \
+    BENCHMARK(BLSDKG_VerifyAndAggregateContributions_##name##_##quorumSize)
+
 BENCH_BuildQuorumVerificationVectors(simple, 10, 1000)
 
 BENCH_BuildQuorumVerificationVectors(simple, 100, 10)
@@ -178,3 +214,9 @@ BENCH_VerifyContributionShares(aggregated, 10, 5, true, 100)
 BENCH_VerifyContributionShares(aggregated, 100, 5, true, 10)
 
 BENCH_VerifyContributionShares(aggregated, 400, 5, true, 1)
+
+BENCH_VerifyAndAggregateContributions(simple, 50, 5, 10)
+
+BENCH_VerifyAndAggregateContributions(simple, 100, 5, 10)
+
+BENCH_VerifyAndAggregateContributions(simple, 400, 5, 1)
@@ -5,6 +5,7 @@
 #include <bench/bench.h>
 #include <coins.h>
 #include <policy/policy.h>
+#include <random.h>
 #include <wallet/crypter.h>
 
 #include <vector>
@@ -87,4 +88,66 @@ static void CCoinsCaching(benchmark::Bench &bench) {
     ECC_Stop();
 }
 
+static constexpr size_t CACHING_BENCH_COINS = 10000;
+
+static std::vector <std::pair<COutPoint, Coin>> CreateRandomCoins(size_t count) {
+    FastRandomContext rng(true);
+    std::vector <std::pair<COutPoint, Coin>> coins;
+    coins.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        Coin coin;
+        coin.out.nValue = rng.randrange(100 * COIN);
+        coin.out.scriptPubKey.assign(25, OP_NOP);
+        coin.nHeight = 1 + rng.randrange(1000000);
+        coins.emplace_back(COutPoint(rng.rand256(), rng.randrange(4)), std::move(coin));
+    }
+    return coins;
+}
+
+static void AddRandomCoins(CCoinsViewCache &cache, const std::vector <std::pair<COutPoint, Coin>> &coins) {
+    for (const auto &entry: coins) {
+        cache.AddCoin(entry.first, Coin(entry.second), false);
+    }
+}
+
+// Throughput of filling an empty cache, this is dominated by allocating the CCoinsMap nodes.
+static void CCoinsCachingInsert(benchmark::Bench &bench) {
+    const auto coins = CreateRandomCoins(CACHING_BENCH_COINS);
+    CCoinsView coinsDummy;
+    bench.batch(coins.size()).unit("coin").run([&] {
+        CCoinsViewCache cache(&coinsDummy);
+        AddRandomCoins(cache, coins);
+        assert(cache.GetCacheSize() == coins.size());
+    });
+}
+
+static void CCoinsCachingLookup(benchmark::Bench &bench) {
+    const auto coins = CreateRandomCoins(CACHING_BENCH_COINS);
+    CCoinsView coinsDummy;
+    CCoinsViewCache cache(&coinsDummy);
+    AddRandomCoins(cache, coins);
+    bench.batch(coins.size()).unit("coin").run([&] {
+        for (const auto &entry: coins) {
+            const Coin &coin = cache.AccessCoin(entry.first);
+            assert(!coin.IsSpent());
+        }
+    });
+}
+
+// Flushing a child cache into its parent, as done for every connected block.
+static void CCoinsCachingFlush(benchmark::Bench &bench) {
+    const auto coins = CreateRandomCoins(CACHING_BENCH_COINS);
+    CCoinsView coinsDummy;
+    bench.batch(coins.size()).unit("coin").run([&] {
+        CCoinsViewCache parent(&coinsDummy);
+        CCoinsViewCache child(&parent);
+        AddRandomCoins(child, coins);
+        bool success = child.Flush();
+        assert(success && parent.GetCacheSize() == coins.size());
+    });
+}
+
 BENCHMARK(CCoinsCaching);
+BENCHMARK(CCoinsCachingInsert);
+BENCHMARK(CCoinsCachingLookup);
+BENCHMARK(CCoinsCachingFlush);
@@ -2,10 +2,20 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <algorithm>
+#include <future>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+#include <assets/assetstype.h>
 #include <blockfilter.h>
+#include <evo/providertx.h>
+#include <evo/specialtx.h>
 #include <hash.h>
 #include <primitives/transaction.h>
 #include <script/script.h>
+#include <script/standard.h>
 #include <streams.h>
 
 /// SerType used to serialize parameters in GCS filter encoding.
@@ -94,7 +104,7 @@ GCSFilter::GCSFilter(uint64_t siphash_k0, uint64_t siphash_k1, uint8_t P, uint32
         : m_siphash_k0(siphash_k0), m_siphash_k1(siphash_k1), m_P(P), m_M(M), m_N(0), m_F(0) {}
 
 GCSFilter::GCSFilter(uint64_t siphash_k0, uint64_t siphash_k1, uint8_t P, uint32_t M,
-                     std::vector<unsigned char> encoded_filter)
+                     std::vector<unsigned char> encoded_filter, bool skip_decode_check)
         : GCSFilter(siphash_k0, siphash_k1, P, M) {
     m_encoded = std::move(encoded_filter);
 
@@ -107,6 +117,8 @@ GCSFilter::GCSFilter(uint64_t siphash_k0, uint64_t siphash_k1, uint8_t P, uint32
     }
     m_F = static_cast<uint64_t>(m_N) * static_cast<uint64_t>(m_M);
 
+    if (skip_decode_check) return;
+
     // Verify that the encoded filter contains exactly N elements. If it has too much or too little
     // data, a std::ios_base::failure exception will be raised.
     BitStreamReader <VectorReader> bitreader(stream);
@@ -189,6 +201,58 @@ bool GCSFilter::MatchAny(const ElementSet &elements) const {
     return MatchInternal(queries.data(), queries.size());
 }
 
+static const std::map <BlockFilterType, std::string> g_filter_types = {
+        {BlockFilterType::BASIC_FILTER, "basic"},
+        {BlockFilterType::ASSET_FILTER, "asset"},
+};
+
+const std::string &BlockFilterTypeName(BlockFilterType filter_type) {
+    static std::string unknown_retval = "";
+    auto it = g_filter_types.find(filter_type);
+    return it != g_filter_types.end() ? it->second : unknown_retval;
+}
+
+bool BlockFilterTypeByName(const std::string &name, BlockFilterType &filter_type) {
+    for (const auto &entry: g_filter_types) {
+        if (entry.second == name) {
+            filter_type = entry.first;
+            return true;
+        }
+    }
+    return false;
+}
+
+const std::set <BlockFilterType> &AllBlockFilterTypes() {
+    static std::set <BlockFilterType> types;
+
+    static std::once_flag flag;
+    std::call_once(flag, []() {
+        for (auto entry: g_filter_types) {
+            types.insert(entry.first);
+        }
+    });
+
+    return types;
+}
+
+const std::string &ListBlockFilterTypes() {
+    static std::string type_list;
+
+    static std::once_flag flag;
+    std::call_once(flag, []() {
+        std::stringstream ret;
+        bool first = true;
+        for (auto entry: g_filter_types) {
+            if (!first) ret << ", ";
+            ret << entry.second;
+            first = false;
+        }
+        type_list = ret.str();
+    });
+
+    return type_list;
+}
+
 static GCSFilter::ElementSet BasicFilterElements(const CBlock &block,
                                                  const CBlockUndo &block_undo) {
     GCSFilter::ElementSet elements;
@@ -212,6 +276,143 @@ static GCSFilter::ElementSet BasicFilterElements(const CBlock &block,
     return elements;
 }
 
+static GCSFilter::Element TaggedElement(const std::string &tag, const unsigned char *begin, const unsigned char *end) {
+    GCSFilter::Element element(tag.begin(), tag.end());
+    element.push_back(0);
+    element.insert(element.end(), begin, end);
+    return element;
+}
+
+GCSFilter::Element AssetFilterAssetIdElement(const std::string &assetId) {
+    return TaggedElement("asset", (const unsigned char *) assetId.data(),
+                         (const unsigned char *) assetId.data() + assetId.size());
+}
+
+GCSFilter::Element AssetFilterProTxElement(const uint256 &proTxHash) {
+    return TaggedElement("protx", proTxHash.begin(), proTxHash.end());
+}
+
+GCSFilter::Element AssetFilterFutureElement(const CScript &lockScript) {
+    return TaggedElement("future", lockScript.data(), lockScript.data() + lockScript.size());
+}
+
+GCSFilter::Element AssetFilterTxTypeElement(uint16_t nType) {
+    const unsigned char vchType[2] = {(unsigned char) (nType & 0xff), (unsigned char) (nType >> 8)};
+    return TaggedElement("txtype", vchType, vchType + 2);
+}
+
+/** Adds the asset id and the plain address script of an asset transfer script */
+static void AddAssetScriptElements(const CScript &script, GCSFilter::ElementSet &elements) {
+    if (!script.IsAssetScript()) return;
+
+    CAssetTransfer transfer;
+    if (GetTransferAsset(script, transfer)) {
+        elements.insert(AssetFilterAssetIdElement(transfer.assetId));
+    }
+    CTxDestination dest;
+    if (ExtractDestination(script, dest)) {
+        const CScript addressScript = GetScriptForDestination(dest);
+        elements.emplace(addressScript.begin(), addressScript.end());
+    }
+}
+
+static void AddAddressElement(const CKeyID &keyID, GCSFilter::ElementSet &elements) {
+    if (keyID.IsNull()) return;
+    const CScript script = GetScriptForDestination(keyID);
+    elements.emplace(script.begin(), script.end());
+}
+
+static GCSFilter::ElementSet AssetFilterElements(const CBlock &block,
+                                                 const CBlockUndo &block_undo) {
+    GCSFilter::ElementSet elements = BasicFilterElements(block, block_undo);
+
+    for (const CTransactionRef &tx: block.vtx) {
+        for (const CTxOut &txout: tx->vout) {
+            AddAssetScriptElements(txout.scriptPubKey, elements);
+        }
+
+        if (tx->nVersion != 3 || tx->nType == TRANSACTION_NORMAL) continue;
+        elements.insert(AssetFilterTxTypeElement(tx->nType));
+
+        switch (tx->nType) {
+            case TRANSACTION_PROVIDER_REGISTER:
+                elements.insert(AssetFilterProTxElement(tx->GetHash()));
+                break;
+            case TRANSACTION_PROVIDER_UPDATE_SERVICE: {
+                CProUpServTx proTx;
+                if (GetTxPayload(*tx, proTx)) elements.insert(AssetFilterProTxElement(proTx.proTxHash));
+                break;
+            }
+            case TRANSACTION_PROVIDER_UPDATE_REGISTRAR: {
+                CProUpRegTx proTx;
+                if (GetTxPayload(*tx, proTx)) elements.insert(AssetFilterProTxElement(proTx.proTxHash));
+                break;
+            }
+            case TRANSACTION_PROVIDER_UPDATE_REVOKE: {
+                CProUpRevTx proTx;
+                if (GetTxPayload(*tx, proTx)) elements.insert(AssetFilterProTxElement(proTx.proTxHash));
+                break;
+            }
+            case TRANSACTION_FUTURE: {
+                CFutureTx futureTx;
+                if (GetTxPayload(*tx, futureTx) && futureTx.lockOutputIndex < tx->vout.size()) {
+                    elements.insert(AssetFilterFutureElement(tx->vout[futureTx.lockOutputIndex].scriptPubKey));
+                }
+                break;
+            }
+            case TRANSACTION_NEW_ASSET: {
+                // The asset id is the id of the transaction creating it
+                CNewAssetTx assetTx;
+                if (GetTxPayload(*tx, assetTx)) {
+                    elements.insert(AssetFilterAssetIdElement(tx->GetHash().ToString()));
+                    AddAddressElement(assetTx.ownerAddress, elements);
+                    AddAddressElement(assetTx.targetAddress, elements);
+                }
+                break;
+            }
+            case TRANSACTION_UPDATE_ASSET: {
+                CUpdateAssetTx assetTx;
+                if (GetTxPayload(*tx, assetTx)) {
+                    elements.insert(AssetFilterAssetIdElement(assetTx.assetId));
+                    AddAddressElement(assetTx.ownerAddress, elements);
+                    AddAddressElement(assetTx.targetAddress, elements);
+                }
+                break;
+            }
+            case TRANSACTION_MINT_ASSET: {
+                CMintAssetTx assetTx;
+                if (GetTxPayload(*tx, assetTx)) elements.insert(AssetFilterAssetIdElement(assetTx.assetId));
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    for (const CTxUndo &tx_undo: block_undo.vtxundo) {
+        for (const Coin &prevout: tx_undo.vprevout) {
+            AddAssetScriptElements(prevout.out.scriptPubKey, elements);
+        }
+    }
+
+    return elements;
+}
+
+BlockFilter::BlockFilter(BlockFilterType filter_type, const uint256 &block_hash,
+                         std::vector<unsigned char> filter, bool skip_decode_check)
+        : m_filter_type(filter_type), m_block_hash(block_hash) {
+    switch (m_filter_type) {
+        case BlockFilterType::BASIC_FILTER:
+        case BlockFilterType::ASSET_FILTER:
+            m_filter = GCSFilter(m_block_hash.GetUint64(0), m_block_hash.GetUint64(1),
+                                 BASIC_FILTER_P, BASIC_FILTER_M, std::move(filter), skip_decode_check);
+            break;
+
+        default:
+            throw std::invalid_argument("unknown filter_type");
+    }
+}
+
 BlockFilter::BlockFilter(BlockFilterType filter_type, const CBlock &block, const CBlockUndo &block_undo)
         : m_filter_type(filter_type), m_block_hash(block.GetHash()) {
     switch (m_filter_type) {
@@ -221,6 +422,12 @@ BlockFilter::BlockFilter(BlockFilterType filter_type, const CBlock &block, const
                                  BasicFilterElements(block, block_undo));
             break;
 
+        case BlockFilterType::ASSET_FILTER:
+            m_filter = GCSFilter(m_block_hash.GetUint64(0), m_block_hash.GetUint64(1),
+                                 BASIC_FILTER_P, BASIC_FILTER_M,
+                                 AssetFilterElements(block, block_undo));
+            break;
+
         default:
             throw std::invalid_argument("unknown filter_type");
     }
@@ -244,3 +451,31 @@ uint256 BlockFilter::ComputeHeader(const uint256 &prev_header) const {
             .Finalize(result);
     return result;
 }
+
+std::vector<bool> BlockFiltersMatchAny(const std::vector<BlockFilter> &filters, const GCSFilter::ElementSet &elements,
+                                       int num_threads) {
+    // Don't bother with threads for a few filters
+    static constexpr size_t MIN_FILTERS_PER_THREAD = 16;
+    const size_t num_runs = std::max<size_t>(1, std::min<size_t>(num_threads, filters.size() / MIN_FILTERS_PER_THREAD));
+    const size_t run_size = (filters.size() + num_runs - 1) / num_runs;
+
+    auto matchRun = [&filters, &elements](size_t begin, size_t end) {
+        std::vector<bool> matches;
+        matches.reserve(end - begin);
+        for (size_t i = begin; i < end; i++) {
+            matches.push_back(filters[i].GetFilter().MatchAny(elements));
+        }
+        return matches;
+    };
+
+    std::vector<std::future<std::vector<bool>>> futures;
+    for (size_t begin = run_size; begin < filters.size(); begin += run_size) {
+        futures.emplace_back(std::async(std::launch::async, matchRun, begin, std::min(begin + run_size, filters.size())));
+    }
+    std::vector<bool> matches = matchRun(0, std::min(run_size, filters.size()));
+    for (auto &future: futures) {
+        const std::vector<bool> run_matches = future.get();
+        matches.insert(matches.end(), run_matches.begin(), run_matches.end());
+    }
+    return matches;
+}
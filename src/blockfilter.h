@@ -7,6 +7,7 @@
 
 #include <set>
 #include <stdint.h>
+#include <string>
 #include <vector>
 
 #include <primitives/block.h>
@@ -45,9 +46,12 @@ public:
     /** Constructs an empty filter. */
     GCSFilter(uint64_t siphash_k0 = 0, uint64_t siphash_k1 = 0, uint8_t P = 0, uint32_t M = 0);
 
-    /** Reconstructs an already-created filter from an encoding. */
+    /**
+     * Reconstructs an already-created filter from an encoding. The elements are decoded to check that the encoding
+     * holds exactly N of them, unless skip_decode_check is set because the encoding comes from a trusted source.
+     */
     GCSFilter(uint64_t siphash_k0, uint64_t siphash_k1, uint8_t P, uint32_t M,
-              std::vector<unsigned char> encoded_filter);
+              std::vector<unsigned char> encoded_filter, bool skip_decode_check = false);
 
     /** Builds a new filter from the params and set of elements. */
     GCSFilter(uint64_t siphash_k0, uint64_t siphash_k1, uint8_t P, uint32_t M,
@@ -82,25 +86,63 @@ BASIC_FILTER_M = 784931;
 
 enum BlockFilterType : uint8_t {
     BASIC_FILTER = 0,
+    //! BASIC_FILTER elements plus asset ids, asset addresses, future locks and special transaction identifiers
+    ASSET_FILTER = 1,
+    INVALID = 255,
 };
 
+/** Get the human-readable name for a filter type. Returns empty string for unknown types. */
+const std::string &BlockFilterTypeName(BlockFilterType filter_type);
+
+/** Find a filter type by its human-readable name. */
+bool BlockFilterTypeByName(const std::string &name, BlockFilterType &filter_type);
+
+/** Get a list of known filter types. */
+const std::set <BlockFilterType> &AllBlockFilterTypes();
+
+/** Get a comma-separated list of known filter type names. */
+const std::string &ListBlockFilterTypes();
+
+/**
+ * Elements committed by ASSET_FILTER next to the scripts, to query it for. Each kind is tagged so it can't collide
+ * with a script or with another kind.
+ */
+GCSFilter::Element AssetFilterAssetIdElement(const std::string &assetId);
+
+/** A ProRegTx, or a ProTx updating or revoking the masternode registered by it */
+GCSFilter::Element AssetFilterProTxElement(const uint256 &proTxHash);
+
+/** The output locked by a future transaction */
+GCSFilter::Element AssetFilterFutureElement(const CScript &lockScript);
+
+/** Any special transaction of this type */
+GCSFilter::Element AssetFilterTxTypeElement(uint16_t nType);
+
 /**
  * Complete block filter struct as defined in BIP 157. Serialization matches
  * payload of "cfilter" messages.
  */
 class BlockFilter {
 private:
-    BlockFilterType m_filter_type;
+    BlockFilterType m_filter_type = BlockFilterType::INVALID;
     uint256 m_block_hash;
     GCSFilter m_filter;
 
 public:
 
+    BlockFilter() = default;
+
+    //! Reconstruct a BlockFilter from parts.
+    BlockFilter(BlockFilterType filter_type, const uint256 &block_hash,
+                std::vector<unsigned char> filter, bool skip_decode_check = false);
+
     // Construct a new BlockFilter of the specified type from a block.
     BlockFilter(BlockFilterType filter_type, const CBlock &block, const CBlockUndo &block_undo);
 
     BlockFilterType GetFilterType() const { return m_filter_type; }
 
+    const uint256 &GetBlockHash() const { return m_block_hash; }
+
     const GCSFilter &GetFilter() const { return m_filter; }
 
     const std::vector<unsigned char> &GetEncodedFilter() const {
@@ -133,6 +175,7 @@ public:
 
         switch (m_filter_type) {
             case BlockFilterType::BASIC_FILTER:
+            case BlockFilterType::ASSET_FILTER:
                 m_filter = GCSFilter(m_block_hash.GetUint64(0), m_block_hash.GetUint64(1),
                                      BASIC_FILTER_P, BASIC_FILTER_M, std::move(encoded_filter));
                 break;
@@ -143,4 +186,11 @@ public:
     }
 };
 
+/**
+ * GCSFilter::MatchAny over each of the filters, the runs of filters are matched concurrently on up to num_threads
+ * threads. Each filter hashes all elements with its own key, so this is worth it for large element sets.
+ */
+std::vector<bool> BlockFiltersMatchAny(const std::vector<BlockFilter> &filters, const GCSFilter::ElementSet &elements,
+                                       int num_threads);
+
 #endif // BITCOIN_BLOCKFILTER_H
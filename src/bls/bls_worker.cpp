@@ -10,6 +10,8 @@
 #include <util/ranges.h>
 #include <util/system.h>
 
+#include <algorithm>
+
 template<typename T>
 bool VerifyVectorHelper(const std::vector <T> &vec, size_t start, size_t count) {
     if (start == 0 && count == 0) {
@@ -54,8 +56,8 @@ CBLSWorker::~CBLSWorker() {
 }
 
 void CBLSWorker::Start() {
-    int workerCount = std::thread::hardware_concurrency() / 2;
-    workerCount = std::max(std::min(1, workerCount), 4);
+    // DKG work is split into chunks sized to the number of workers, so give it all cores
+    int workerCount = std::max(1, std::min((int) std::thread::hardware_concurrency(), MAX_WORKER_COUNT));
     workerPool.resize(workerCount);
     RenameThreadPool(workerPool, "bls-work");
 }
@@ -65,6 +67,12 @@ void CBLSWorker::Stop() {
     workerPool.stop(true);
 }
 
+size_t CBLSWorker::GetChunkSize(size_t count, size_t maxChunkSize) {
+    // a few chunks per worker allow to balance out uneven work
+    size_t chunkCount = std::max(1, workerPool.size()) * 4;
+    return std::max<size_t>(1, std::min(maxChunkSize, (count + chunkCount - 1) / chunkCount));
+}
+
 bool CBLSWorker::GenerateContributions(int quorumThreshold, const BLSIdVector &ids, BLSVerificationVectorPtr &vvecRet,
                                        BLSSecretKeyVector &skSharesRet) {
     auto svec = BLSSecretKeyVector((size_t) quorumThreshold);
@@ -74,7 +82,7 @@ bool CBLSWorker::GenerateContributions(int quorumThreshold, const BLSIdVector &i
     for (int i = 0; i < quorumThreshold; i++) {
         svec[i].MakeNewKey();
     }
-    size_t batchSize = 8;
+    size_t batchSize = GetChunkSize(std::max<size_t>(quorumThreshold, ids.size()));
     std::vector <std::future<bool>> futures;
     futures.reserve((quorumThreshold / batchSize + ids.size() / batchSize) + 2);
 
@@ -562,7 +570,7 @@ void CBLSWorker::AsyncBuildQuorumVerificationVector(const std::vector <BLSVerifi
         doneCallback(nullptr);
         return;
     }
-    if (!VerifyVerificationVectors(vvecs, start, count)) {
+    if (!(parallel ? VerifyVerificationVectorsParallel(vvecs, start, count) : VerifyVerificationVectors(vvecs, start, count))) {
         doneCallback(nullptr);
         return;
     }
@@ -659,15 +667,16 @@ void CBLSWorker::AsyncVerifyContributionShares(const CBLSId &forId, const std::v
                                                const BLSSecretKeyVector &skShares,
                                                bool parallel, bool aggregated,
                                                std::function<void(const std::vector<bool> &)> doneCallback) {
-    if (!forId.IsValid() || !VerifyVerificationVectors(vvecs)) {
+    if (!forId.IsValid() || !(parallel ? VerifyVerificationVectorsParallel(vvecs, 0, vvecs.size()) : VerifyVerificationVectors(vvecs))) {
         std::vector<bool> result;
         result.assign(vvecs.size(), false);
         doneCallback(result);
         return;
     }
 
-    auto verifier = std::make_shared<ContributionVerifier>(forId, vvecs, skShares, 8, parallel, aggregated, workerPool,
-                                                           std::move(doneCallback));
+    size_t batchSize = parallel ? GetChunkSize(vvecs.size(), CONTRIBUTION_VERIFY_MAX_BATCH_SIZE) : CONTRIBUTION_VERIFY_MAX_BATCH_SIZE;
+    auto verifier = std::make_shared<ContributionVerifier>(forId, vvecs, skShares, batchSize, parallel, aggregated,
+                                                           workerPool, std::move(doneCallback));
     verifier->Start();
 }
 
@@ -708,6 +717,35 @@ std::future<bool> CBLSWorker::AsyncVerifyContributionShare(const CBLSId &forId,
     return workerPool.push(f);
 }
 
+bool CBLSWorker::VerifyAndAggregateContributions(const CBLSId &forId,
+                                                 const std::vector <BLSVerificationVectorPtr> &vvecs,
+                                                 const BLSSecretKeyVector &skShares, std::vector<bool> &validRet,
+                                                 BLSVerificationVectorPtr &quorumVvecRet, CBLSSecretKey &skShareRet) {
+    validRet = VerifyContributionShares(forId, vvecs, skShares, true, true);
+    if (validRet.size() != vvecs.size()) {
+        return false;
+    }
+
+    std::vector <BLSVerificationVectorPtr> validVvecs;
+    BLSSecretKeyVector validSkShares;
+    for (size_t i = 0; i < vvecs.size(); i++) {
+        if (validRet[i]) {
+            validVvecs.emplace_back(vvecs[i]);
+            validSkShares.emplace_back(skShares[i]);
+        }
+    }
+    if (validVvecs.empty()) {
+        return false;
+    }
+
+    // both aggregations are parallelized internally, running them at the same time keeps all workers busy
+    auto vvecFuture = AsyncBuildQuorumVerificationVector(validVvecs, 0, 0, true);
+    auto skShareFuture = AsyncAggregateSecretKeys(validSkShares, 0, 0, true);
+    quorumVvecRet = vvecFuture.get();
+    skShareRet = skShareFuture.get();
+    return quorumVvecRet != nullptr && skShareRet.IsValid();
+}
+
 bool CBLSWorker::VerifyVerificationVector(const BLSVerificationVector &vvec, size_t start, size_t count) {
     return VerifyVectorHelper(vvec, start, count);
 }
@@ -741,6 +779,56 @@ bool CBLSWorker::VerifyVerificationVectors(const std::vector <BLSVerificationVec
     return true;
 }
 
+bool CBLSWorker::VerifyVerificationVectorsParallel(const std::vector <BLSVerificationVectorPtr> &vvecs,
+                                                   size_t start, size_t count) {
+    if (start == 0 && count == 0) {
+        count = vvecs.size();
+    }
+    if (count == 0 || vvecs[start] == nullptr) {
+        return count == 0;
+    }
+    const size_t vvecSize = vvecs[start]->size();
+
+    // checking validity and hashing every public key is the expensive part, so do it in chunks on the workers and
+    // only check for duplicates afterwards
+    std::vector <uint256> hashes(count * vvecSize);
+    size_t chunkSize = GetChunkSize(count);
+    std::vector <std::future<bool>> futures;
+    futures.reserve(count / chunkSize + 1);
+    for (size_t i = 0; i < count; i += chunkSize) {
+        size_t chunkStart = i;
+        size_t chunkCount = std::min(chunkSize, count - chunkStart);
+        auto f = [&, chunkStart, chunkCount](int threadId) {
+            for (size_t j = chunkStart; j < chunkStart + chunkCount; j++) {
+                const auto &vvec = vvecs[start + j];
+                if (vvec == nullptr || vvec->size() != vvecSize) {
+                    return false;
+                }
+                for (size_t k = 0; k < vvecSize; k++) {
+                    if (!(*vvec)[k].IsValid()) {
+                        return false;
+                    }
+                    hashes[j * vvecSize + k] = (*vvec)[k].GetHash();
+                }
+            }
+            return true;
+        };
+        futures.emplace_back(workerPool.push(f));
+    }
+    // wait for all chunks, even if one of them failed already, as they all reference our locals
+    bool valid = true;
+    for (auto &f: futures) {
+        valid &= f.get();
+    }
+    if (!valid) {
+        return false;
+    }
+
+    // check duplicates
+    std::sort(hashes.begin(), hashes.end());
+    return std::adjacent_find(hashes.begin(), hashes.end()) == hashes.end();
+}
+
 void CBLSWorker::AsyncSign(const CBLSSecretKey &secKey, const uint256 &msgHash,
                            const CBLSWorker::SignDoneCallback &doneCallback) {
     workerPool.push([secKey, msgHash, doneCallback](int threadId) {
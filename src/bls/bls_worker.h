@@ -11,6 +11,7 @@
 #include <ctpl_stl.h>
 
 #include <future>
+#include <limits>
 #include <mutex>
 #include <utility>
 
@@ -28,6 +29,10 @@ private:
     ctpl::thread_pool workerPool;
 
     static const int SIG_VERIFY_BATCH_SIZE = 8;
+    // maximum number of contributions aggregated into a single batch when verifying contributions. Batches are only
+    // as large as needed to keep all workers busy, as a failed batch has to be re-verified one-by-one
+    static const size_t CONTRIBUTION_VERIFY_MAX_BATCH_SIZE = 8;
+    static const int MAX_WORKER_COUNT = 8;
 
     struct SigVerifyJob {
         SigVerifyDoneCallback doneCallback;
@@ -59,6 +64,9 @@ public:
 
     void Stop();
 
+    // Splits count items into chunks so that all workers get a few chunks each, but no chunk is larger than maxChunkSize
+    size_t GetChunkSize(size_t count, size_t maxChunkSize = std::numeric_limits<size_t>::max());
+
     bool GenerateContributions(int threshold, const BLSIdVector &ids, BLSVerificationVectorPtr &vvecRet,
                                BLSSecretKeyVector &skSharesRet);
 
@@ -140,6 +148,13 @@ public:
     std::future<bool> AsyncVerifyContributionShare(const CBLSId &forId, const BLSVerificationVectorPtr &vvec,
                                                    const CBLSSecretKey &skContribution);
 
+    // Full DKG pipeline for a single member: verifies all contributions for forId and then builds the quorum
+    // verification vector and the member's secret key share from the valid contributions. The verification vector
+    // and the secret key share are aggregated concurrently. Must not be called from a worker thread.
+    bool VerifyAndAggregateContributions(const CBLSId &forId, const std::vector <BLSVerificationVectorPtr> &vvecs,
+                                         const BLSSecretKeyVector &skShares, std::vector<bool> &validRet,
+                                         BLSVerificationVectorPtr &quorumVvecRet, CBLSSecretKey &skShareRet);
+
     // Simple verification of vectors. Checks x.IsValid() for every entry and checks for duplicate entries
     static bool VerifyVerificationVector(const BLSVerificationVector &vvec, size_t start = 0, size_t count = 0);
 
@@ -159,6 +174,10 @@ public:
 
 private:
     void PushSigVerifyBatch();
+
+    // Same as VerifyVerificationVectors, but validity checks and hashing are split into chunks and done by the workers
+    bool VerifyVerificationVectorsParallel(const std::vector <BLSVerificationVectorPtr> &vvecs, size_t start,
+                                           size_t count);
 };
 
 // Builds and caches different things from CBLSWorker
@@ -191,6 +210,21 @@ public:
         });
     }
 
+    // The async variants allow to build the verification vector and the secret key share concurrently.
+    // Inputs must stay alive until the returned futures are ready
+    std::shared_future <BLSVerificationVectorPtr>
+    AsyncBuildQuorumVerificationVector(const uint256 &cacheKey, const std::vector <BLSVerificationVectorPtr> &vvecs) {
+        return GetOrBuildAsync(cacheKey, vvecCache, [this, &vvecs]() {
+            return worker.AsyncBuildQuorumVerificationVector(vvecs, 0, 0, true);
+        });
+    }
+
+    std::shared_future <CBLSSecretKey> AsyncAggregateSecretKeys(const uint256 &cacheKey, const BLSSecretKeyVector &skShares) {
+        return GetOrBuildAsync(cacheKey, secretKeyShareCache, [this, &skShares]() {
+            return worker.AsyncAggregateSecretKeys(skShares, 0, 0, true);
+        });
+    }
+
     CBLSPublicKey BuildPubKeyShare(const uint256 &cacheKey, const BLSVerificationVectorPtr &vvec, const CBLSId &id) {
         return GetOrBuild(cacheKey, publicKeyShareCache, [&vvec, &id]() {
             return CBLSWorker::BuildPubKeyShare(vvec, id);
@@ -216,6 +250,19 @@ private:
         p.set_value(v);
         return v;
     }
+
+    template<typename T, typename AsyncBuilder>
+    std::shared_future <T>
+    GetOrBuildAsync(const uint256 &cacheKey, std::map <uint256, std::shared_future<T>> &cache, AsyncBuilder &&builder) {
+        std::unique_lock <std::mutex> l(cacheCs);
+        auto it = cache.find(cacheKey);
+        if (it != cache.end()) {
+            return it->second;
+        }
+        auto f = builder().share();
+        cache.emplace(cacheKey, f);
+        return f;
+    }
 };
 
 #endif //RAPTOREUM_CRYPTO_BLS_WORKER_H
@@ -5,6 +5,8 @@
 
 #include <chain.h>
 
+#include <memusage.h>
+
 /**
  * CChain implementation
  */
@@ -121,6 +123,35 @@ void CBlockIndex::BuildSkip() {
         pskip = pprev->GetAncestor(GetSkipHeight(nHeight));
 }
 
+void CBlockIndexArena::Reserve(size_t n) {
+    if (n == 0 || (!vSlabs.empty() && vSlabs.back().nSize - vSlabs.back().nUsed >= n)) {
+        return;
+    }
+    vSlabs.push_back(Slab{std::unique_ptr<CBlockIndex[]>(new CBlockIndex[n]), n, 0});
+}
+
+CBlockIndex *CBlockIndexArena::Allocate() {
+    if (vSlabs.empty() || vSlabs.back().nUsed == vSlabs.back().nSize) {
+        Reserve(SLAB_SIZE);
+    }
+    Slab &slab = vSlabs.back();
+    nAllocated++;
+    return &slab.entries[slab.nUsed++];
+}
+
+void CBlockIndexArena::Clear() {
+    vSlabs.clear();
+    nAllocated = 0;
+}
+
+size_t CBlockIndexArena::DynamicMemoryUsage() const {
+    size_t nUsage = memusage::DynamicUsage(vSlabs);
+    for (const Slab &slab: vSlabs) {
+        nUsage += memusage::MallocUsage(slab.nSize * sizeof(CBlockIndex));
+    }
+    return nUsage;
+}
+
 arith_uint256 GetBlockProof(const CBlockIndex &block) {
     arith_uint256 bnTarget;
     bool fNegative;
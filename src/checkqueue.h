@@ -235,8 +235,11 @@ public:
     }
 
     void Add(std::vector <T> &vChecks) {
-        if (pqueue != nullptr)
+        if (pqueue != nullptr && !vChecks.empty()) {
             pqueue->Add(vChecks);
+            // Checks added after a Wait() are waited for again when going out of scope
+            fDone = false;
+        }
     }
 
     ~CCheckQueueControl() {
@@ -10,6 +10,8 @@
 #include <random.h>
 #include <future/utils.h>
 
+#include <algorithm>
+
 bool CCoinsView::GetCoin(const COutPoint &outpoint, Coin &coin) const { return false; }
 
 uint256 CCoinsView::GetBestBlock() const { return uint256(); }
@@ -18,6 +20,8 @@ std::vector <uint256> CCoinsView::GetHeadBlocks() const { return std::vector<uin
 
 bool CCoinsView::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) { return false; }
 
+bool CCoinsView::BatchWritePartial(CCoinsMap &mapCoins, const uint256 &hashBlock) { return false; }
+
 CCoinsViewCursor *CCoinsView::Cursor() const { return nullptr; }
 
 bool CCoinsView::HaveCoin(const COutPoint &outpoint) const {
@@ -25,12 +29,29 @@ bool CCoinsView::HaveCoin(const COutPoint &outpoint) const {
     return GetCoin(outpoint, coin);
 }
 
+size_t CCoinsView::GetCoins(const std::vector <COutPoint> &outpoints, std::vector <Coin> &coins) const {
+    coins.resize(outpoints.size());
+    size_t nFound = 0;
+    for (size_t i = 0; i < outpoints.size(); i++) {
+        if (GetCoin(outpoints[i], coins[i]) && !coins[i].IsSpent()) {
+            nFound++;
+        } else {
+            coins[i].Clear();
+        }
+    }
+    return nFound;
+}
+
 CCoinsViewBacked::CCoinsViewBacked(CCoinsView *viewIn) : base(viewIn) {}
 
 bool CCoinsViewBacked::GetCoin(const COutPoint &outpoint, Coin &coin) const { return base->GetCoin(outpoint, coin); }
 
 bool CCoinsViewBacked::HaveCoin(const COutPoint &outpoint) const { return base->HaveCoin(outpoint); }
 
+size_t CCoinsViewBacked::GetCoins(const std::vector <COutPoint> &outpoints, std::vector <Coin> &coins) const {
+    return base->GetCoins(outpoints, coins);
+}
+
 uint256 CCoinsViewBacked::GetBestBlock() const { return base->GetBestBlock(); }
 
 std::vector <uint256> CCoinsViewBacked::GetHeadBlocks() const { return base->GetHeadBlocks(); }
@@ -41,6 +62,10 @@ bool CCoinsViewBacked::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock)
     return base->BatchWrite(mapCoins, hashBlock);
 }
 
+bool CCoinsViewBacked::BatchWritePartial(CCoinsMap &mapCoins, const uint256 &hashBlock) {
+    return base->BatchWritePartial(mapCoins, hashBlock);
+}
+
 CCoinsViewCursor *CCoinsViewBacked::Cursor() const { return base->Cursor(); }
 
 size_t CCoinsViewBacked::EstimateSize() const { return base->EstimateSize(); }
@@ -48,12 +73,20 @@ size_t CCoinsViewBacked::EstimateSize() const { return base->EstimateSize(); }
 SaltedOutpointHasher::SaltedOutpointHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())),
                                                k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
 
-CCoinsViewCache::CCoinsViewCache(CCoinsView *baseIn) : CCoinsViewBacked(baseIn), cachedCoinsUsage(0) {}
+CCoinsViewCache::CCoinsViewCache(CCoinsView *baseIn) : CCoinsViewBacked(baseIn),
+                                                       cacheCoins(0, SaltedOutpointHasher(), CCoinsMap::key_equal(),
+                                                                  &m_cache_coins_memory_resource),
+                                                       cachedCoinsUsage(0) {}
 
 size_t CCoinsViewCache::DynamicMemoryUsage() const {
     return memusage::DynamicUsage(cacheCoins) + cachedCoinsUsage;
 }
 
+size_t CCoinsViewCache::ReusableMemoryUsage() const {
+    return m_cache_coins_memory_resource.NumAllocatedChunks() * m_cache_coins_memory_resource.ChunkSizeBytes() -
+           m_cache_coins_memory_resource.UsedBytes();
+}
+
 CCoinsMap::iterator CCoinsViewCache::FetchCoin(const COutPoint &outpoint) const {
     CCoinsMap::iterator it = cacheCoins.find(outpoint);
     if (it != cacheCoins.end())
@@ -72,6 +105,54 @@ CCoinsMap::iterator CCoinsViewCache::FetchCoin(const COutPoint &outpoint) const
     return ret;
 }
 
+size_t CCoinsViewCache::PrefetchCoins(const std::vector <COutPoint> &outpoints) const {
+    std::vector <COutPoint> vMissing;
+    vMissing.reserve(outpoints.size());
+    for (const COutPoint &outpoint: outpoints) {
+        if (!cacheCoins.count(outpoint)) {
+            vMissing.emplace_back(outpoint);
+        }
+    }
+    if (vMissing.empty()) {
+        return 0;
+    }
+    // Duplicates would be looked up twice and the second emplace below would be a no-op anyway
+    std::sort(vMissing.begin(), vMissing.end());
+    vMissing.erase(std::unique(vMissing.begin(), vMissing.end()), vMissing.end());
+
+    std::vector <Coin> vCoins;
+    base->GetCoins(vMissing, vCoins);
+
+    size_t nLoaded = 0;
+    for (size_t i = 0; i < vMissing.size(); i++) {
+        // Same as FetchCoin: outpoints the base doesn't know about are not cached
+        if (vCoins[i].IsSpent()) continue;
+        auto res = cacheCoins.emplace(std::piecewise_construct, std::forward_as_tuple(vMissing[i]),
+                                      std::forward_as_tuple(std::move(vCoins[i])));
+        if (res.second) {
+            cachedCoinsUsage += res.first->second.coin.DynamicMemoryUsage();
+            nLoaded++;
+        }
+    }
+    return nLoaded;
+}
+
+size_t CCoinsViewCache::GetCoins(const std::vector <COutPoint> &outpoints, std::vector <Coin> &coins) const {
+    PrefetchCoins(outpoints);
+    coins.resize(outpoints.size());
+    size_t nFound = 0;
+    for (size_t i = 0; i < outpoints.size(); i++) {
+        CCoinsMap::const_iterator it = cacheCoins.find(outpoints[i]);
+        if (it != cacheCoins.end() && !it->second.coin.IsSpent()) {
+            coins[i] = it->second.coin;
+            nFound++;
+        } else {
+            coins[i].Clear();
+        }
+    }
+    return nFound;
+}
+
 bool CCoinsViewCache::GetCoin(const COutPoint &outpoint, Coin &coin) const {
     CCoinsMap::const_iterator it = FetchCoin(outpoint);
     if (it != cacheCoins.end()) {
@@ -238,9 +319,27 @@ bool CCoinsViewCache::Flush() {
     bool fOk = base->BatchWrite(cacheCoins, hashBlock);
     cacheCoins.clear();
     cachedCoinsUsage = 0;
+    // Give the pool's chunks back, a flushed cache would otherwise keep its peak memory usage
+    ReallocateCache();
     return fOk;
 }
 
+bool CCoinsViewCache::FlushPartial(size_t nMaxUsage) {
+    CCoinsMapMemoryResource resource;
+    CCoinsMap mapWrite(0, SaltedOutpointHasher(), CCoinsMap::key_equal(), &resource);
+    size_t nFreed = 0;
+    for (CCoinsMap::iterator it = cacheCoins.begin(); it != cacheCoins.end() && nFreed < nMaxUsage;) {
+        const size_t nCoinUsage = it->second.coin.DynamicMemoryUsage();
+        nFreed += nCoinUsage + sizeof(CCoinsMap::value_type);
+        cachedCoinsUsage -= nCoinUsage;
+        if (it->second.flags & CCoinsCacheEntry::DIRTY) {
+            mapWrite.emplace(it->first, std::move(it->second));
+        }
+        it = cacheCoins.erase(it);
+    }
+    return base->BatchWritePartial(mapWrite, hashBlock);
+}
+
 void CCoinsViewCache::Uncache(const COutPoint &hash) {
     CCoinsMap::iterator it = cacheCoins.find(hash);
     if (it != cacheCoins.end() && it->second.flags == 0) {
@@ -279,7 +378,9 @@ void CCoinsViewCache::ReallocateCache() {
     // Cache should be empty when we're calling this.
     assert(cacheCoins.size() == 0);
     cacheCoins.~CCoinsMap();
-    ::new(&cacheCoins) CCoinsMap();
+    m_cache_coins_memory_resource.~CCoinsMapMemoryResource();
+    ::new(&m_cache_coins_memory_resource) CCoinsMapMemoryResource{};
+    ::new(&cacheCoins) CCoinsMap(0, SaltedOutpointHasher(), CCoinsMap::key_equal(), &m_cache_coins_memory_resource);
 }
 
 static const size_t MAX_OUTPUTS_PER_BLOCK = MaxBlockSize() / ::GetSerializeSize(CTxOut(), SER_NETWORK,
@@ -295,18 +396,30 @@ const Coin &AccessByTxid(const CCoinsViewCache &view, const uint256 &txid) {
     return coinEmpty;
 }
 
+void CCoinsViewErrorCatcher::HandleReadError(const std::runtime_error &e) const {
+    for (auto f: m_err_callbacks) {
+        f();
+    }
+    LogPrintf("Error reading from database: %s\n", e.what());
+    // Starting the shutdown sequence and returning false to the caller would be
+    // interpreted as 'entry not found' (as opposed to unable to read data), and
+    // could lead to invalid interpretation. Just exit immediately, as we can't
+    // continue anyway, and all writes should be atomic.
+    std::abort();
+}
+
 bool CCoinsViewErrorCatcher::GetCoin(const COutPoint &outpoint, Coin &coin) const {
     try {
         return CCoinsViewBacked::GetCoin(outpoint, coin);
     } catch (const std::runtime_error &e) {
-        for (auto f: m_err_callbacks) {
-            f();
-        }
-        LogPrintf("Error reading from database: %s\n", e.what());
-        // Starting the shutdown sequence and returning false to the caller would be
-        // interpreted as 'entry not found' (as opposed to unable to read data), and
-        // could lead to invalid interpretation. Just exit immediately, as we can't
-        // continue anyway, and all writes should be atomic.
-        std::abort();
+        HandleReadError(e);
+    }
+}
+
+size_t CCoinsViewErrorCatcher::GetCoins(const std::vector <COutPoint> &outpoints, std::vector <Coin> &coins) const {
+    try {
+        return CCoinsViewBacked::GetCoins(outpoints, coins);
+    } catch (const std::runtime_error &e) {
+        HandleReadError(e);
     }
 }
@@ -12,6 +12,7 @@
 #include <hash.h>
 #include <memusage.h>
 #include <serialize.h>
+#include <support/allocators/pool.h>
 #include <uint256.h>
 
 #include <assert.h>
@@ -161,7 +162,22 @@ struct CCoinsCacheEntry {
     explicit CCoinsCacheEntry(Coin &&coin_) : coin(std::move(coin_)), flags(0) {}
 };
 
-typedef std::unordered_map <COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMap;
+/**
+ * PoolAllocator's MAX_BLOCK_SIZE_BYTES parameter here uses sizeof the data, and adds the size
+ * of 4 pointers. We do not know the exact node size used in the std::unordered_node implementation
+ * because it is implementation defined. Most implementations have an overhead of 1 or 2 pointers,
+ * so nodes can be connected in a linked list, and in some cases the hash value is stored as well.
+ * Using an additional sizeof(void*)*4 for MAX_BLOCK_SIZE_BYTES should thus be sufficient so that
+ * all implementations can allocate the nodes from the PoolAllocator.
+ */
+using CCoinsMap = std::unordered_map <COutPoint,
+        CCoinsCacheEntry,
+        SaltedOutpointHasher,
+        std::equal_to<COutPoint>,
+        PoolAllocator<std::pair<const COutPoint, CCoinsCacheEntry>,
+                sizeof(std::pair<const COutPoint, CCoinsCacheEntry>) + sizeof(void *) * 4>>;
+
+using CCoinsMapMemoryResource = CCoinsMap::allocator_type::ResourceType;
 
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor {
@@ -199,6 +215,13 @@ public:
     //! Just check whether a given outpoint is unspent.
     virtual bool HaveCoin(const COutPoint &outpoint) const;
 
+    /** Retrieve the Coins for a batch of outpoints at once.
+     *  coins is resized to match outpoints, outpoints which are not found (or spent) leave a spent Coin at their
+     *  position. Returns the number of unspent coins found. Views backed by slow storage override this to issue
+     *  the lookups together instead of one after another.
+     */
+    virtual size_t GetCoins(const std::vector <COutPoint> &outpoints, std::vector <Coin> &coins) const;
+
     //! Retrieve the block hash whose state this CCoinsView currently represents
     virtual uint256 GetBestBlock() const;
 
@@ -212,6 +235,10 @@ public:
     //! The passed mapCoins can be modified.
     virtual bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock);
 
+    //! Like BatchWrite, but mapCoins only holds a part of the changes up to hashBlock. The view stays marked as
+    //! being in transition towards hashBlock until a BatchWrite completes it. Returns false if not supported.
+    virtual bool BatchWritePartial(CCoinsMap &mapCoins, const uint256 &hashBlock);
+
     //! Get a cursor to iterate over the whole state
     virtual CCoinsViewCursor *Cursor() const;
 
@@ -235,6 +262,8 @@ public:
 
     bool HaveCoin(const COutPoint &outpoint) const override;
 
+    size_t GetCoins(const std::vector <COutPoint> &outpoints, std::vector <Coin> &coins) const override;
+
     uint256 GetBestBlock() const override;
 
     std::vector <uint256> GetHeadBlocks() const override;
@@ -243,6 +272,8 @@ public:
 
     bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
 
+    bool BatchWritePartial(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
+
     CCoinsViewCursor *Cursor() const override;
 
     size_t EstimateSize() const override;
@@ -257,6 +288,8 @@ protected:
      * declared as "const".
      */
     mutable uint256 hashBlock;
+    /* Backs the nodes of cacheCoins, must be declared (and therefore constructed) before it. */
+    mutable CCoinsMapMemoryResource m_cache_coins_memory_resource{};
     mutable CCoinsMap cacheCoins;
 
     /* Cached dynamic memory usage for the inner Coin objects. */
@@ -275,12 +308,17 @@ public:
 
     bool HaveCoin(const COutPoint &outpoint) const override;
 
+    size_t GetCoins(const std::vector <COutPoint> &outpoints, std::vector <Coin> &coins) const override;
+
     uint256 GetBestBlock() const override;
 
     void SetBestBlock(const uint256 &hashBlock);
 
     bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
 
+    //! Partial writes only make sense for views which can replay the missing part, like the coins database
+    bool BatchWritePartial(CCoinsMap &mapCoins, const uint256 &hashBlock) override { return false; }
+
     CCoinsViewCursor *Cursor() const override {
         throw std::logic_error("CCoinsViewCache cursor iteration not supported.");
     }
@@ -292,6 +330,12 @@ public:
      */
     bool HaveCoinInCache(const COutPoint &outpoint) const;
 
+    /**
+     * Load all given outpoints which are not cached yet with a single GetCoins() call on the backing view, so
+     * subsequent AccessCoin()/HaveCoin() calls for them are served from memory. Returns the number of coins loaded.
+     */
+    size_t PrefetchCoins(const std::vector <COutPoint> &outpoints) const;
+
     /**
      * Return a reference to Coin in the cache, or coinEmpty if not found. This is
      * more efficient than GetCoin.
@@ -324,6 +368,14 @@ public:
      */
     bool Flush();
 
+    /**
+     * Push a part of the modifications applied to this cache to its base, which must support partial writes.
+     * Dirty coins are written and dropped from the cache together with clean ones until about nMaxUsage bytes
+     * of memory were freed. The base's best block isn't moved, a later Flush() completes the transition.
+     * If false is returned, the state of this cache (and its backing view) will be undefined.
+     */
+    bool FlushPartial(size_t nMaxUsage);
+
     /**
      * Removes the UTXO with the given outpoint from the cache, if it is
      * not modified.
@@ -336,6 +388,9 @@ public:
     //! Calculate the size of the cache (in bytes)
     size_t DynamicMemoryUsage() const;
 
+    //! Part of DynamicMemoryUsage() which is allocated but not in use, new coins are stored there first
+    size_t ReusableMemoryUsage() const;
+
     /** 
      * Amount of 405Coin coming in to a transaction
      * Note that lightweight clients may not know anything besides the hash of previous transactions,
@@ -391,7 +446,11 @@ public:
 
     bool GetCoin(const COutPoint &outpoint, Coin &coin) const override;
 
+    size_t GetCoins(const std::vector <COutPoint> &outpoints, std::vector <Coin> &coins) const override;
+
 private:
+    [[noreturn]] void HandleReadError(const std::runtime_error &e) const;
+
     /** A list of callbacks to execute upon leveldb read error. */
     std::vector <std::function<void()>> m_err_callbacks;
 
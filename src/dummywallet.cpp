@@ -70,6 +70,7 @@ void DummyWalletInit::AddWalletOptions() const {
                                 "-coinjoinmultisession",
                                 "-coinjoinrounds=<n>",
                                 "-coinjoinsessions=<n>",
+                                "-checkwalletbalance",
                                 "-dblogsize=<n>",
                                 "-flushwallet",
                                 "-privdb",
@@ -15,6 +15,7 @@
 #include <chain.h>
 #include <chainparams.h>
 #include <consensus/merkle.h>
+#include <metrics.h>
 
 bool CheckCbTx(const CTransaction &tx, const CBlockIndex *pindexPrev, CValidationState &state) {
     if (tx.nType != TRANSACTION_COINBASE) {
@@ -93,6 +94,9 @@ bool CheckCbTxMerkleRoots(const CBlock &block, const CBlockIndex *pindex, CValid
         nTimeMerkleMNL += nTime3 - nTime2;
         LogPrint(BCLog::BENCHMARK, "          - CalcCbTxMerkleRootMNList: %.2fms [%.2fs]\n", 0.001 * (nTime3 - nTime2),
                  nTimeMerkleMNL * 0.000001);
+        static auto &histMerkleMNL = metrics::GetRegistry().GetHistogram("cbtx_merkle_mnlist_ms",
+                                                                         "Time to verify the MN list merkle root of a coinbase");
+        histMerkleMNL.Observe(0.001 * (nTime3 - nTime2));
 
         if (cbTx.nVersion >= 2) {
             if (!CalcCbTxMerkleRootQuorums(block, pindex->pprev, calculatedMerkleRoot, state)) {
@@ -108,6 +112,9 @@ bool CheckCbTxMerkleRoots(const CBlock &block, const CBlockIndex *pindex, CValid
         nTimeMerkleQuorum += nTime4 - nTime3;
         LogPrint(BCLog::BENCHMARK, "          - CalcCbTxMerkleRootQuorums: %.2fms [%.2fs]\n", 0.001 * (nTime4 - nTime3),
                  nTimeMerkleQuorum * 0.000001);
+        static auto &histMerkleQuorums = metrics::GetRegistry().GetHistogram("cbtx_merkle_quorums_ms",
+                                                                             "Time to verify the quorum merkle root of a coinbase");
+        histMerkleQuorums.Observe(0.001 * (nTime4 - nTime3));
 
     }
 
@@ -13,14 +13,35 @@
 #include <streams.h>
 #include <util/system.h>
 
+#include <algorithm>
+
 /**
 *   Generic Dumping and Loading
 *   ---------------------------
+*
+*   Files are written in checksummed chunks:
+*
+*       FLATDB_CHUNKED_MARKER, FLATDB_FORMAT_VERSION
+*       for each chunk of at most FLATDB_CHUNK_SIZE bytes: size (uint32), data, double-SHA256 of data
+*       0 (uint32), double-SHA256 of all chunk hashes
+*
+*   The chunks hold the magic message, the network magic number and the serialized object. Files written before
+*   the chunked format start with the length of the magic message instead of the marker and are still read; they
+*   hold the same data followed by a single double-SHA256 of it.
+*
+*   Reading and verifying a file is split from deserializing it, so several files can be read ahead at startup while
+*   the block index is loaded, and a large one can be deserialized in the background.
 */
 
+static const uint8_t FLATDB_CHUNKED_MARKER = 0xff;
+static const uint8_t FLATDB_FORMAT_VERSION = 1;
+static const uint32_t FLATDB_CHUNK_SIZE = 1 << 20;
+//! Larger chunks are never written, a bigger size means the file is corrupted
+static const uint32_t FLATDB_MAX_CHUNK_SIZE = 1 << 25;
+
 template<typename T>
 class CFlatDB {
-private:
+public:
 
     enum ReadResult {
         Ok,
@@ -29,9 +50,18 @@ private:
         IncorrectHash,
         IncorrectMagicMessage,
         IncorrectMagicNumber,
-        IncorrectFormat
+        IncorrectFormat,
+        IncorrectVersion
+    };
+
+    /** Verified file contents, the stream is left at the serialized object */
+    struct Payload {
+        ReadResult result{FileError};
+        CDataStream ssObj{SER_DISK, CLIENT_VERSION};
     };
 
+private:
+
     fs::path pathDB;
     std::string strFilename;
     std::string strMagicMessage;
@@ -41,13 +71,11 @@ private:
 
         int64_t nStart = GetTimeMillis();
 
-        // serialize, checksum data up to that point, then append checksum
+        // serialize, then checksum each chunk and all of them together
         CDataStream ssObj(SER_DISK, CLIENT_VERSION);
         ssObj << strMagicMessage; // specific magic message for this type of object
         ssObj << Params().MessageStart(); // network specific magic number
         ssObj << objToSave;
-        uint256 hash = Hash(ssObj.begin(), ssObj.end());
-        ssObj << hash;
 
         // open output file, and associate with CAutoFile
         FILE *file = fopen(pathDB.string().c_str(), "wb");
@@ -57,7 +85,17 @@ private:
 
         // Write and commit header, data
         try {
-            fileout << ssObj;
+            fileout << FLATDB_CHUNKED_MARKER << FLATDB_FORMAT_VERSION;
+            CHashWriter hasherChunks(SER_GETHASH, 0);
+            for (size_t nPos = 0; nPos < ssObj.size(); nPos += FLATDB_CHUNK_SIZE) {
+                const uint32_t nSize = std::min<size_t>(FLATDB_CHUNK_SIZE, ssObj.size() - nPos);
+                const uint256 hash = Hash(ssObj.begin() + nPos, ssObj.begin() + nPos + nSize);
+                fileout << nSize;
+                fileout.write(ssObj.data() + nPos, nSize);
+                fileout << hash;
+                hasherChunks << hash;
+            }
+            fileout << uint32_t{0} << hasherChunks.GetHash();
         }
         catch (std::exception &e) {
             return error("%s: Serialize or I/O error - %s", __func__, e.what());
@@ -70,40 +108,25 @@ private:
         return true;
     }
 
-    ReadResult Read(T &objToLoad, bool fDryRun = false) {
-        //LOCK(objToLoad.cs);
-
-        int64_t nStart = GetTimeMillis();
-        // open input file, and associate with CAutoFile
-        FILE *file = fopen(pathDB.string().c_str(), "rb");
-        CAutoFile filein(file, SER_DISK, CLIENT_VERSION);
-        if (filein.IsNull()) {
-            error("%s: Failed to open file %s", __func__, pathDB.string());
-            return FileError;
-        }
-
+    ReadResult ReadLegacy(CAutoFile &filein, CDataStream &ssObj) {
         // use file size to size memory buffer
         int fileSize = fs::file_size(pathDB);
         int dataSize = fileSize - sizeof(uint256);
         // Don't try to resize to a negative number if file is small
         if (dataSize < 0)
             dataSize = 0;
-        std::vector<unsigned char> vchData;
-        vchData.resize(dataSize);
+        ssObj.resize(dataSize);
         uint256 hashIn;
 
         // read data and checksum from file
         try {
-            filein.read((char *) vchData.data(), dataSize);
+            filein.read(ssObj.data(), dataSize);
             filein >> hashIn;
         }
         catch (std::exception &e) {
             error("%s: Deserialize or I/O error - %s", __func__, e.what());
             return HashReadError;
         }
-        filein.fclose();
-
-        CDataStream ssObj(vchData, SER_DISK, CLIENT_VERSION);
 
         // verify stored checksum matches input data
         uint256 hashTmp = Hash(ssObj.begin(), ssObj.end());
@@ -111,7 +134,75 @@ private:
             error("%s: Checksum mismatch, data corrupted", __func__);
             return IncorrectHash;
         }
+        return Ok;
+    }
 
+    ReadResult ReadChunks(CAutoFile &filein, CDataStream &ssObj) {
+        try {
+            uint8_t nVersion;
+            filein >> nVersion;
+            if (nVersion != FLATDB_FORMAT_VERSION) {
+                error("%s: Unknown format version %d", __func__, nVersion);
+                return IncorrectVersion;
+            }
+
+            ssObj.reserve(fs::file_size(pathDB));
+            CHashWriter hasherChunks(SER_GETHASH, 0);
+            for (int nChunk = 0;; nChunk++) {
+                uint32_t nSize;
+                uint256 hashIn;
+                filein >> nSize;
+                if (nSize == 0) {
+                    filein >> hashIn;
+                    if (hashIn != hasherChunks.GetHash()) {
+                        error("%s: Checksum mismatch, chunks missing or corrupted", __func__);
+                        return IncorrectHash;
+                    }
+                    return Ok;
+                }
+                if (nSize > FLATDB_MAX_CHUNK_SIZE) {
+                    error("%s: Chunk %d has invalid size %u", __func__, nChunk, nSize);
+                    return HashReadError;
+                }
+                const size_t nPos = ssObj.size();
+                ssObj.resize(nPos + nSize);
+                filein.read(ssObj.data() + nPos, nSize);
+                filein >> hashIn;
+                if (hashIn != Hash(ssObj.begin() + nPos, ssObj.end())) {
+                    error("%s: Checksum mismatch in chunk %d, data corrupted", __func__, nChunk);
+                    return IncorrectHash;
+                }
+                hasherChunks << hashIn;
+            }
+        }
+        catch (std::exception &e) {
+            error("%s: Deserialize or I/O error - %s", __func__, e.what());
+            return HashReadError;
+        }
+    }
+
+    ReadResult Read(CDataStream &ssObj) {
+        // open input file, and associate with CAutoFile
+        FILE *file = fopen(pathDB.string().c_str(), "rb");
+        CAutoFile filein(file, SER_DISK, CLIENT_VERSION);
+        if (filein.IsNull()) {
+            error("%s: Failed to open file %s", __func__, pathDB.string());
+            return FileError;
+        }
+
+        // the length of the magic message of a legacy file is never encoded as FLATDB_CHUNKED_MARKER
+        const int nMarker = fgetc(filein.Get());
+        ReadResult result;
+        if (nMarker == FLATDB_CHUNKED_MARKER) {
+            result = ReadChunks(filein, ssObj);
+        } else {
+            rewind(filein.Get());
+            result = ReadLegacy(filein, ssObj);
+        }
+        filein.fclose();
+        if (result != Ok) {
+            return result;
+        }
 
         unsigned char pchMsgTmp[4];
         std::string strMagicMessageTmp;
@@ -134,7 +225,17 @@ private:
                 error("%s: Invalid network magic number", __func__);
                 return IncorrectMagicNumber;
             }
+        }
+        catch (std::exception &e) {
+            error("%s: Deserialize or I/O error - %s", __func__, e.what());
+            return IncorrectFormat;
+        }
+        return Ok;
+    }
 
+    ReadResult Deserialize(T &objToLoad, CDataStream &ssObj) {
+        int64_t nStart = GetTimeMillis();
+        try {
             // de-serialize data into T object
             ssObj >> objToLoad;
         }
@@ -146,11 +247,9 @@ private:
 
         LogPrintf("Loaded info from %s  %dms\n", strFilename, GetTimeMillis() - nStart);
         LogPrintf("     %s\n", objToLoad.ToString());
-        if (!fDryRun) {
-            LogPrintf("%s: Cleaning....\n", __func__);
-            objToLoad.CheckAndRemove();
-            LogPrintf("     %s\n", objToLoad.ToString());
-        }
+        LogPrintf("%s: Cleaning....\n", __func__);
+        objToLoad.CheckAndRemove();
+        LogPrintf("     %s\n", objToLoad.ToString());
 
         return Ok;
     }
@@ -163,9 +262,20 @@ public:
         strMagicMessage = strMagicMessageIn;
     }
 
-    bool Load(T &objToLoad) {
+    /** Reads and verifies the file without deserializing it, safe to call from any thread */
+    Payload ReadPayload() {
+        int64_t nStart = GetTimeMillis();
         LogPrintf("Reading info from %s...\n", strFilename);
-        ReadResult readResult = Read(objToLoad);
+        Payload payload;
+        payload.result = Read(payload.ssObj);
+        if (payload.result == Ok) {
+            LogPrintf("Read %s  %d bytes  %dms\n", strFilename, payload.ssObj.size(), GetTimeMillis() - nStart);
+        }
+        return payload;
+    }
+
+    /** Logs why the file couldn't be loaded, returns false if it's invalid and shouldn't be recreated */
+    bool CheckReadResult(ReadResult readResult) const {
         if (readResult == FileError)
             LogPrintf("Missing file %s, will try to recreate\n", strFilename);
         else if (readResult != Ok) {
@@ -181,24 +291,27 @@ public:
         return true;
     }
 
+    /** Deserializes a payload from ReadPayload, objToLoad is left as is if the file is missing */
+    bool Load(T &objToLoad, Payload &payload) {
+        if (payload.result == Ok) {
+            payload.result = Deserialize(objToLoad, payload.ssObj);
+        }
+        return CheckReadResult(payload.result);
+    }
+
+    bool Load(T &objToLoad) {
+        Payload payload = ReadPayload();
+        return Load(objToLoad, payload);
+    }
+
     bool Dump(T &objToSave) {
         int64_t nStart = GetTimeMillis();
 
+        // there was an error and it was not an error on file opening or deserializing => do not proceed
         LogPrintf("Verifying %s format...\n", strFilename);
-        T tmpObjToLoad;
-        ReadResult readResult = Read(tmpObjToLoad, true);
-
-        // there was an error and it was not an error on file opening => do not proceed
-        if (readResult == FileError)
-            LogPrintf("Missing file %s, will try to recreate\n", strFilename);
-        else if (readResult != Ok) {
-            LogPrintf("Error reading %s: ", strFilename);
-            if (readResult == IncorrectFormat)
-                LogPrintf("%s: Magic is ok but data has invalid format, will try to recreate\n", __func__);
-            else {
-                LogPrintf("%s: File format is unknown or invalid, please fix it manually\n", __func__);
-                return false;
-            }
+        CDataStream ssObj(SER_DISK, CLIENT_VERSION);
+        if (!CheckReadResult(Read(ssObj))) {
+            return false;
         }
 
         LogPrintf("Writing info to %s...\n", strFilename);
@@ -10,6 +10,10 @@
 #include <tinyformat.h>
 #include <util/system.h>
 
+#ifdef HAVE_POSIX_FADVISE
+#include <fcntl.h>
+#endif
+
 FlatFileSeq::FlatFileSeq(fs::path dir, const char *prefix, size_t chunk_size) :
         m_dir(std::move(dir)),
         m_prefix(prefix),
@@ -73,6 +77,17 @@ size_t FlatFileSeq::Allocate(const FlatFilePos &pos, size_t add_size, bool &out_
     return 0;
 }
 
+void FlatFileSeq::ReadAhead(const FlatFilePos &pos, size_t length) {
+#ifdef HAVE_POSIX_FADVISE
+    FILE *file = Open(FlatFilePos(pos.nFile, 0), true);
+    if (!file) {
+        return;
+    }
+    posix_fadvise(fileno(file), pos.nPos, length, POSIX_FADV_WILLNEED);
+    fclose(file);
+#endif
+}
+
 bool FlatFileSeq::Flush(const FlatFilePos &pos, bool finalize) {
     FILE *file = Open(FlatFilePos(pos.nFile, 0)); // Avoid fseek to nPos
     if (!file) {
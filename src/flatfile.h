@@ -82,6 +82,15 @@ public:
      */
     size_t Allocate(const FlatFilePos &pos, size_t add_size, bool &out_of_space);
 
+    /**
+     * Hint to the OS that a range of a file will be read soon, so it's read ahead in the background. Does nothing
+     * where posix_fadvise isn't available.
+     *
+     * @param[in] pos The start of the range.
+     * @param[in] length The number of bytes in the range.
+     */
+    void ReadAhead(const FlatFilePos &pos, size_t length);
+
     /**
      * Commit a file to disk, and optionally truncate off extra pre-allocated bytes if final.
      *
@@ -41,6 +41,8 @@ CGovernanceManager::CGovernanceManager() :
         setRequestedObjects(),
         fRateChecksEnabled(true),
         lastMNListForVotingKeys(std::make_shared<CDeterministicMNList>()),
+        fLoaded(true),
+        pindexLoadingTip(nullptr),
         cs() {
 }
 
@@ -84,7 +86,7 @@ bool CGovernanceManager::SerializeVoteForHash(const uint256 &nHash, CDataStream
 void
 CGovernanceManager::ProcessMessage(CNode *pfrom, const std::string &strCommand, CDataStream &vRecv, CConnman &connman,
                                    bool enable_bip61) {
-    if (fDisableGovernance) return;
+    if (fDisableGovernance || !IsLoaded()) return;
     if (!smartnodeSync.IsBlockchainSynced()) return;
 
     // ANOTHER USER IS ASKING US TO HELP THEM SYNC GOVERNANCE OBJECT DATA
@@ -554,7 +556,7 @@ struct sortProposalsByVotes {
 };
 
 void CGovernanceManager::DoMaintenance(CConnman &connman) {
-    if (fDisableGovernance || !smartnodeSync.IsSynced() || ShutdownRequested()) return;
+    if (fDisableGovernance || !IsLoaded() || !smartnodeSync.IsSynced() || ShutdownRequested()) return;
 
     // CHECK OBJECTS WE'VE ASKED FOR, REMOVE OLD ENTRIES
 
@@ -569,7 +571,7 @@ void CGovernanceManager::DoMaintenance(CConnman &connman) {
 
 bool CGovernanceManager::ConfirmInventoryRequest(const CInv &inv) {
     // do not request objects until it's time to sync
-    if (!smartnodeSync.IsBlockchainSynced()) return false;
+    if (!smartnodeSync.IsBlockchainSynced() || !IsLoaded()) return false;
 
     LOCK(cs);
 
@@ -1151,6 +1153,14 @@ void CGovernanceManager::InitOnLoad() {
     LogPrintf("     %s\n", ToString());
 }
 
+void CGovernanceManager::FinishLoading(CConnman &connman) {
+    fLoaded = true;
+    const CBlockIndex *pindex = pindexLoadingTip.exchange(nullptr);
+    if (pindex) {
+        UpdatedBlockTip(pindex, connman);
+    }
+}
+
 std::string CGovernanceManager::ToString() const {
     LOCK(cs);
 
@@ -1219,6 +1229,12 @@ void CGovernanceManager::UpdatedBlockTip(const CBlockIndex *pindex, CConnman &co
         return;
     }
 
+    if (!IsLoaded()) {
+        // FinishLoading catches up with the tip, unless it's already done with loading
+        pindexLoadingTip = pindex;
+        if (!IsLoaded()) return;
+    }
+
     nCachedBlockHeight = pindex->nHeight;
     LogPrint(BCLog::GOBJECT, "CGovernanceManager::UpdatedBlockTip -- nCachedBlockHeight: %d\n", nCachedBlockHeight);
 
@@ -20,6 +20,8 @@
 
 #include <univalue.h>
 
+#include <atomic>
+
 class CGovernanceManager;
 
 class CGovernanceTriggerManager;
@@ -198,6 +200,12 @@ private:
     // used to check for changed voting keys
     CDeterministicMNListPtr lastMNListForVotingKeys;
 
+    // false while governance.dat is loaded in the background
+    std::atomic<bool> fLoaded;
+
+    // most recent tip seen while loading, processed once loading is done
+    std::atomic<const CBlockIndex *> pindexLoadingTip;
+
     class ScopedLockBool {
         bool &ref;
         bool fPrevValue;
@@ -347,6 +355,16 @@ public:
 
     void InitOnLoad();
 
+    bool IsLoaded() const { return fLoaded; }
+
+    /**
+     * Marks the manager as being loaded in the background. Until FinishLoading is called, objects and votes from
+     * peers are ignored and new tips are only recorded.
+     */
+    void StartLoading() { fLoaded = false; }
+
+    void FinishLoading(CConnman &connman);
+
     int RequestGovernanceObjectVotes(CNode *pnode, CConnman &connman);
 
     int RequestGovernanceObjectVotes(const std::vector<CNode *> &vNodesCopy, CConnman &connman);
@@ -322,14 +322,26 @@ uint64_t SipHashUint256(uint64_t k0, uint64_t k1, const uint256 &val);
 uint64_t SipHashUint256Extra(uint64_t k0, uint64_t k1, const uint256 &val, uint32_t extra);
 
 /* ----------- Ghost Rider Hash ------------------------------------------------ */
+/** Order of the GhostRider rounds, it only depends on the previous block so it can be reused for all its headers */
+struct GRSchedule {
+    std::vector<int> coreHashIndexes;
+    std::vector<int> randomCNs;
+
+    explicit GRSchedule(const uint256 &PrevBlockHash) {
+        HashSelection hashSelection(PrevBlockHash, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14},
+                                    {0, 1, 2, 3, 4, 5});
+        randomCNs = hashSelection.getCnIndexes();
+        coreHashIndexes = hashSelection.getAlgoIndexes();
+    }
+};
+
 template<typename T1>
-inline uint256 HashGR(const T1 pbegin, const T1 pend, const uint256 PrevBlockHash) {
+inline uint256 HashGR(const T1 pbegin, const T1 pend, const GRSchedule &schedule) {
     static unsigned char pblank[1];
 
     uint512 hash[18];
-    HashSelection hashSelection(PrevBlockHash, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14}, {0, 1, 2, 3, 4, 5});
-    std::vector<int> randomCNs(hashSelection.getCnIndexes());
-    std::vector<int> coreHashIndexes(hashSelection.getAlgoIndexes());
+    const std::vector<int> &randomCNs = schedule.randomCNs;
+    const std::vector<int> &coreHashIndexes = schedule.coreHashIndexes;
     for (int i = 0; i < 18; ++i) {
         const void *toHash;
         int lenToHash;
@@ -362,4 +374,9 @@ inline uint256 HashGR(const T1 pbegin, const T1 pend, const uint256 PrevBlockHas
     return hash[17].trim256();
 }
 
+template<typename T1>
+inline uint256 HashGR(const T1 pbegin, const T1 pend, const uint256 PrevBlockHash) {
+    return HashGR(pbegin, pend, GRSchedule(PrevBlockHash));
+}
+
 #endif // BITCOIN_HASH_H
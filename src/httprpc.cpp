@@ -6,6 +6,7 @@
 
 #include <chainparams.h>
 #include <httpserver.h>
+#include <metrics.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
 #include <random.h>
@@ -259,3 +260,22 @@ void StopHTTPRPC() {
         httpRPCTimerInterface.reset();
     }
 }
+
+static bool HTTPReq_Metrics(HTTPRequest *req, const std::string &) {
+    if (req->GetRequestMethod() != HTTPRequest::GET) {
+        req->WriteReply(HTTP_BAD_METHOD, "Metrics are only served for GET requests");
+        return false;
+    }
+    req->WriteHeader("Content-Type", "text/plain; version=0.0.4");
+    req->WriteReply(HTTP_OK, metrics::GetRegistry().RenderPrometheus());
+    return true;
+}
+
+void StartHTTPMetrics() {
+    LogPrint(BCLog::RPC, "Serving metrics on /metrics\n");
+    RegisterHTTPHandler("/metrics", true, HTTPReq_Metrics);
+}
+
+void StopHTTPMetrics() {
+    UnregisterHTTPHandler("/metrics", true);
+}
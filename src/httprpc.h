@@ -37,4 +37,13 @@ void InterruptREST();
  */
 void StopREST();
 
+/** Start serving the metrics registry on /metrics.
+ * Precondition; HTTP has been started.
+ */
+void StartHTTPMetrics();
+
+/** Stop serving /metrics.
+ */
+void StopHTTPMetrics();
+
 #endif
@@ -5,6 +5,7 @@
 #include <map>
 
 #include <dbwrapper.h>
+#include <hash.h>
 #include <index/blockfilterindex.h>
 #include <serialize.h>
 #include <util/system.h>
@@ -32,14 +33,6 @@ constexpr char DB_FILTER_POS = 'P';
 constexpr unsigned int MAX_FLTR_FILE_SIZE = 0x1000000; // 16 MiB
 /** The pre-allocation chunk size for fltr?????.dat files */
 constexpr unsigned int FLTR_FILE_CHUNK_SIZE = 0x100000; // 1 MiB
-/** Maximum size of the cfheaders cache
- *  We have a limit to prevent a bug in filling this cache
- *  potentially turning into an OOM. At 2000 entries, this cache
- *  is big enough for a 2,000,000 length block chain, which
- *  we should be enough until ~2047. */
-constexpr size_t
-CF_HEADERS_CACHE_MAX_SZ{
-2000};
 
 namespace {
 
@@ -148,17 +141,17 @@ bool BlockFilterIndex::CommitInternal(CDBBatch &batch) {
     return BaseIndex::CommitInternal(batch);
 }
 
-bool BlockFilterIndex::ReadFilterFromDisk(const FlatFilePos &pos, BlockFilter &filter) const {
-    CAutoFile filein(m_filter_fileseq->Open(pos, true), SER_DISK, CLIENT_VERSION);
-    if (filein.IsNull()) {
-        return false;
-    }
-
+/** Reads the filter at the current position of filein, checking it against the filter hash stored in the index */
+static bool ReadFilter(CAutoFile &filein, BlockFilterType filter_type, const uint256 &hash, BlockFilter &filter) {
     uint256 block_hash;
     std::vector<unsigned char> encoded_filter;
     try {
         filein >> block_hash >> encoded_filter;
-        filter = BlockFilter(GetFilterType(), block_hash, std::move(encoded_filter));
+        if (Hash(encoded_filter.begin(), encoded_filter.end()) != hash) {
+            return error("%s: Checksum mismatch in filter decode", __func__);
+        }
+        // The filter is what was written, decoding all its elements again to check it would only cost time
+        filter = BlockFilter(filter_type, block_hash, std::move(encoded_filter), /* skip_decode_check */ true);
     }
     catch (const std::exception &e) {
         return error("%s: Failed to deserialize block filter from disk: %s", __func__, e.what());
@@ -167,6 +160,15 @@ bool BlockFilterIndex::ReadFilterFromDisk(const FlatFilePos &pos, BlockFilter &f
     return true;
 }
 
+bool BlockFilterIndex::ReadFilterFromDisk(const FlatFilePos &pos, const uint256 &hash, BlockFilter &filter) const {
+    CAutoFile filein(m_filter_fileseq->Open(pos, true), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull()) {
+        return false;
+    }
+
+    return ReadFilter(filein, GetFilterType(), hash, filter);
+}
+
 size_t BlockFilterIndex::WriteFilterToDisk(FlatFilePos &pos, const BlockFilter &filter) {
     assert(filter.GetFilterType() == GetFilterType());
 
@@ -378,19 +380,18 @@ bool BlockFilterIndex::LookupFilter(const CBlockIndex *block_index, BlockFilter
         return false;
     }
 
-    return ReadFilterFromDisk(entry.pos, filter_out);
+    return ReadFilterFromDisk(entry.pos, entry.hash, filter_out);
 }
 
 bool BlockFilterIndex::LookupFilterHeader(const CBlockIndex *block_index, uint256 &header_out) {
-    LOCK(m_cs_headers_cache);
-
-    bool is_checkpoint{block_index->nHeight % CFCHECKPT_INTERVAL == 0};
+    const bool is_checkpoint{block_index->nHeight > 0 && block_index->nHeight % CFCHECKPT_INTERVAL == 0};
+    const size_t checkpoint = block_index->nHeight / CFCHECKPT_INTERVAL - 1;
 
     if (is_checkpoint) {
-        // Try to find the block in the headers cache if this is a checkpoint height.
-        auto header = m_headers_cache.find(block_index->GetBlockHash());
-        if (header != m_headers_cache.end()) {
-            header_out = header->second;
+        // Try to find the block in the checkpoints cache if this is a checkpoint height.
+        LOCK(m_cs_checkpoints);
+        if (checkpoint < m_checkpoints.size() && m_checkpoints[checkpoint].first == block_index->GetBlockHash()) {
+            header_out = m_checkpoints[checkpoint].second;
             return true;
         }
     }
@@ -400,15 +401,45 @@ bool BlockFilterIndex::LookupFilterHeader(const CBlockIndex *block_index, uint25
         return false;
     }
 
-    if (is_checkpoint && m_headers_cache.size() < CF_HEADERS_CACHE_MAX_SZ) {
-        // Add to the headers cache if this is a checkpoint cache
-        m_headers_cache.emplace(block_index->GetBlockHash(), entry.header);
+    if (is_checkpoint) {
+        LOCK(m_cs_checkpoints);
+        if (checkpoint >= m_checkpoints.size()) {
+            m_checkpoints.resize(checkpoint + 1);
+        }
+        m_checkpoints[checkpoint] = std::make_pair(block_index->GetBlockHash(), entry.header);
     }
 
     header_out = entry.header;
     return true;
 }
 
+bool BlockFilterIndex::LookupFilterCheckpoints(const CBlockIndex *stop_index, std::vector <uint256> &headers_out) {
+    const size_t n_checkpoints = stop_index->nHeight / CFCHECKPT_INTERVAL;
+    headers_out.resize(n_checkpoints);
+
+    LOCK(m_cs_checkpoints);
+    if (m_checkpoints.size() < n_checkpoints) {
+        m_checkpoints.resize(n_checkpoints);
+    }
+
+    const CBlockIndex *block_index = stop_index;
+    for (size_t i = n_checkpoints; i-- > 0;) {
+        block_index = block_index->GetAncestor((i + 1) * CFCHECKPT_INTERVAL);
+        auto &cached = m_checkpoints[i];
+        if (cached.first != block_index->GetBlockHash()) {
+            DBVal entry;
+            if (!LookupOne(*m_db, block_index, entry)) {
+                return error("%s: Failed to find block filter header for %s at height %d",
+                             __func__, block_index->GetBlockHash().ToString(), block_index->nHeight);
+            }
+            cached = std::make_pair(block_index->GetBlockHash(), entry.header);
+        }
+        headers_out[i] = cached.second;
+    }
+
+    return true;
+}
+
 bool BlockFilterIndex::LookupFilterRange(int start_height, const CBlockIndex *stop_index,
                                          std::vector <BlockFilter> &filters_out) const {
     std::vector <DBVal> entries;
@@ -417,12 +448,24 @@ bool BlockFilterIndex::LookupFilterRange(int start_height, const CBlockIndex *st
     }
 
     filters_out.resize(entries.size());
-    auto filter_pos_it = filters_out.begin();
-    for (const auto &entry: entries) {
-        if (!ReadFilterFromDisk(entry.pos, *filter_pos_it)) {
+    size_t i = 0;
+    while (i < entries.size()) {
+        const int n_file = entries[i].pos.nFile;
+        CAutoFile filein(m_filter_fileseq->Open(entries[i].pos, true), SER_DISK, CLIENT_VERSION);
+        if (filein.IsNull()) {
             return false;
         }
-        ++filter_pos_it;
+
+        // Filters of consecutive blocks are written one after the other, so this is mostly a sequential read
+        for (; i < entries.size() && entries[i].pos.nFile == n_file; ++i) {
+            const FlatFilePos &pos = entries[i].pos;
+            if (ftell(filein.Get()) != (long) pos.nPos && fseek(filein.Get(), pos.nPos, SEEK_SET)) {
+                return error("%s: Failed to seek to %s", __func__, pos.ToString());
+            }
+            if (!ReadFilter(filein, GetFilterType(), entries[i].hash, filters_out[i])) {
+                return false;
+            }
+        }
     }
 
     return true;
@@ -13,10 +13,6 @@
 /** Interval between compact filter checkpoints. See BIP 157. */
 static constexpr int CFCHECKPT_INTERVAL = 1000;
 
-struct FilterHeaderHasher {
-    size_t operator()(const uint256 &hash) const { return ReadLE64(hash.begin()); }
-};
-
 /**
  * BlockFilterIndex is used to store and retrieve block filters, hashes, and headers for a range of
  * blocks by height. An index is constructed for each supported filter type with its own database
@@ -33,14 +29,17 @@ private:
     FlatFilePos m_next_filter_pos;
     std::unique_ptr <FlatFileSeq> m_filter_fileseq;
 
-    bool ReadFilterFromDisk(const FlatFilePos &pos, BlockFilter &filter) const;
+    bool ReadFilterFromDisk(const FlatFilePos &pos, const uint256 &hash, BlockFilter &filter) const;
 
     size_t WriteFilterToDisk(FlatFilePos &pos, const BlockFilter &filter);
 
-    Mutex m_cs_headers_cache;
-    /** cache of block hash to filter header, to avoid disk access when responding to getcfcheckpt. */
-    std::unordered_map <uint256, uint256, FilterHeaderHasher> m_headers_cache
-    GUARDED_BY(m_cs_headers_cache);
+    Mutex m_cs_checkpoints;
+    /**
+     * Block hash and filter header at each checkpoint height (CFCHECKPT_INTERVAL, 2 * CFCHECKPT_INTERVAL, ...) of the
+     * chain looked up last, to avoid disk access when responding to getcfcheckpt. Entries are checked against the
+     * block hash, so a reorg or a request for a stale chain just replaces them.
+     */
+    std::vector <std::pair<uint256, uint256>> m_checkpoints GUARDED_BY(m_cs_checkpoints);
 
 protected:
     bool Init() override;
@@ -68,7 +67,16 @@ public:
     /** Get a single filter header by block. */
     bool LookupFilterHeader(const CBlockIndex *block_index, uint256 &header_out);
 
-    /** Get a range of filters between two heights on a chain. */
+    /**
+     * Get the filter headers at all checkpoint heights up to stop_index, as sent in cfcheckpt: the first one is at
+     * height CFCHECKPT_INTERVAL.
+     */
+    bool LookupFilterCheckpoints(const CBlockIndex *stop_index, std::vector <uint256> &headers_out);
+
+    /**
+     * Get a range of filters between two heights on a chain. Filters are read in one pass over each filter file,
+     * seeking only when a filter isn't stored right after the previous one.
+     */
     bool LookupFilterRange(int start_height, const CBlockIndex *stop_index,
                            std::vector <BlockFilter> &filters_out) const;
 
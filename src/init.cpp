@@ -18,6 +18,7 @@
 #include <chain.h>
 #include <chainparams.h>
 #include <checkpoints.h>
+#include <node/blockprefetch.h>
 #include <node/coinstats.h>
 #include <compat/sanity.h>
 #include <consensus/validation.h>
@@ -26,10 +27,12 @@
 #include <httpserver.h>
 #include <httprpc.h>
 #include <interfaces/chain.h>
+#include <index/blockfilterindex.h>
 #include <index/txindex.h>
 #include <interfaces/node.h>
 #include <key.h>
 #include <mapport.h>
+#include <metrics.h>
 #include <validation.h>
 #include <miner.h>
 #include <netbase.h>
@@ -88,14 +91,17 @@
 #include <llmq/quorums_init.h>
 #include <llmq/quorums_blockprocessor.h>
 #include <llmq/quorums_signing.h>
+#include <llmq/quorums_signing_shares.h>
 #include <llmq/quorums_utils.h>
 
 #include <primitives/powcache.h>
 
 #include <statsd_client.h>
+#include <stratum.h>
 
 #include <stdint.h>
 #include <stdio.h>
+#include <future>
 #include <set>
 
 #include <bls/bls.h>
@@ -131,6 +137,17 @@ static constexpr int DUMP_BANS_INTERVAL = 60 * 15;
 
 static CDSNotificationInterface *pdsNotificationInterface = nullptr;
 
+static std::set <BlockFilterType> g_enabled_filter_types;
+
+/** Reads and verifies a cache file on another thread, so it overlaps with loading the block index */
+template<typename T>
+static std::future<typename CFlatDB<T>::Payload> ReadCacheFileAsync(const std::string &strFilename,
+                                                                   const std::string &strMagicMessage) {
+    return std::async(std::launch::async, [strFilename, strMagicMessage] {
+        return CFlatDB<T>(strFilename, strMagicMessage).ReadPayload();
+    });
+}
+
 #ifdef WIN32
 // Win32 LevelDB doesn't use filedescriptors, and the ones used for
 // accessing block files don't count towards the fd_set size limit
@@ -200,10 +217,12 @@ void Interrupt(NodeContext &node) {
     InterruptRPC();
     InterruptREST();
     InterruptTorControl();
+    InterruptStratum();
     llmq::InterruptLLMQSystem();
     InterruptMapPort();
     if (node.connman) node.connman->Interrupt();
     if (g_txindex) g_txindex->Interrupt();
+    ForEachBlockFilterIndex([](BlockFilterIndex &index) { index.Interrupt(); });
 }
 
 /** Preparing steps before shutting down or restarting the wallet */
@@ -221,6 +240,7 @@ void PrepareShutdown(NodeContext &node) {
     mempool.AddTransactionsUpdated(1);
     StopHTTPRPC();
     StopREST();
+    StopHTTPMetrics();
     StopRPC();
     StopHTTPServer();
     llmq::StopLLMQSystem();
@@ -241,6 +261,7 @@ void PrepareShutdown(NodeContext &node) {
     if (node.connman) node.connman->Stop();
 
     StopTorControl();
+    StopStratum();
 
     // After everything has been shut down, but before things get flushed, stop the
     // CScheduler/checkqueue, threadGroup/scheduler and load block thread.
@@ -271,6 +292,7 @@ void PrepareShutdown(NodeContext &node) {
 
     // After the threads that potentially access these pointers have been stopped,
     // destruct and reset all to nullptr.
+    node.template_builder.reset();
     node.peer_logic.reset();
     node.connman.reset();
     node.banman.reset();
@@ -306,6 +328,8 @@ void PrepareShutdown(NodeContext &node) {
         g_txindex->Stop();
         g_txindex.reset();
     }
+    ForEachBlockFilterIndex([](BlockFilterIndex &index) { index.Stop(); });
+    DestroyAllBlockFilterIndexes();
 
     // Any future callbacks will be dropped. This should absolutely be safe - if
     // missing a callback results in an unrecoverable situation, unclean shutdown
@@ -366,6 +390,7 @@ void PrepareShutdown(NodeContext &node) {
     }
 #endif
     node.chain_clients.clear();
+    statsClient.StopFlushThread();
     UnregisterAllValidationInterfaces();
     GetMainSignals().UnregisterBackgroundSignalScheduler();
     GetMainSignals().UnregisterWithMempoolSignals(mempool);
@@ -392,6 +417,7 @@ void Shutdown(NodeContext &node) {
     node.chainman = nullptr;
     node.scheduler.reset();
     LogPrintf("%s: done\n", __func__);
+    LogInstance().StopAsyncLogging();
 }
 
 /**
@@ -502,6 +528,10 @@ void SetupServerArgs() {
     gArgs.AddArg("-dbcache=<n>",
                  strprintf("Set database cache size in megabytes (%d to %d, default: %d)", nMinDbCache, nMaxDbCache,
                            nDefaultDbCache), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-dbflushchunk=<n>",
+                 strprintf("When the coins cache is close to its limit, write and evict at most this many megabytes of it "
+                           "instead of flushing it completely, 0 to always flush completely (default: %d)",
+                           nDefaultDbFlushChunk), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     gArgs.AddArg("-powcachesize=<n>",
                  strprintf("Set ProofOfWork cache size in megabytes (default: %d)", DEFAULT_POW_CACHE_SIZE),
                  ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
@@ -525,9 +555,16 @@ void SetupServerArgs() {
     gArgs.AddArg("-maxorphantxsize=<n>",
                  strprintf("Maximum total size of all orphan transactions in megabytes (default: %u)",
                            DEFAULT_MAX_ORPHAN_TRANSACTIONS_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-maxorphantxsizeperpeer=<n>",
+                 strprintf("Maximum total size of orphan transactions kept from a single peer in megabytes (default: %u)",
+                           DEFAULT_MAX_ORPHAN_TRANSACTIONS_SIZE_PER_PEER), ArgsManager::ALLOW_ANY,
+                 OptionsCategory::OPTIONS);
     gArgs.AddArg("-maxrecsigsage=<n>", strprintf("Number of seconds to keep LLMQ recovery sigs (default: %u)",
                                                  llmq::DEFAULT_MAX_RECOVERED_SIGS_AGE), ArgsManager::ALLOW_ANY,
                  OptionsCategory::OPTIONS);
+    gArgs.AddArg("-maxsigsharesmem=<n>",
+                 strprintf("Keep LLMQ signing session state below <n> megabytes, oldest sessions are dropped first (default: %u)",
+                           llmq::DEFAULT_MAX_SIGSHARES_MEMORY), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     gArgs.AddArg("-mempoolexpiry=<n>",
                  strprintf("Do not keep transactions in the mempool longer than <n> hours (default: %u)",
                            DEFAULT_MEMPOOL_EXPIRY), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
@@ -555,6 +592,9 @@ void SetupServerArgs() {
             "Warning: Reverting this setting requires re-downloading the entire blockchain. "
             "(default: 0 = disable pruning blocks, 1 = allow manual pruning via RPC, >%u = automatically prune block files to stay under the specified target size in MiB)",
             MIN_DISK_SPACE_FOR_BLOCK_FILES / 1024 / 1024), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-recsigcache=<n>",
+                 strprintf("Memory budget in megabytes for LLMQ recovered sig lookup caches (default: %u)",
+                           llmq::DEFAULT_RECOVERED_SIGS_CACHE_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     gArgs.AddArg("-syncmempool",
                  strprintf("Sync mempool from other nodes on start (default: %u)", DEFAULT_SYNC_MEMPOOL),
                  ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
@@ -578,6 +618,9 @@ void SetupServerArgs() {
     gArgs.AddArg("-powheaderthreads", strprintf(
             "Set max pow threads to be used while processing headers (default: %d)",
             DEFAULT_POWHEADERTHREADS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-blockprefetchthreads", strprintf(
+            "Set the number of threads reading blocks ahead when reindexing, importing, verifying and rescanning, 0 to read them as they are needed (default: %d)",
+            DEFAULT_BLOCK_PREFETCH_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     gArgs.AddArg("-addressindex", strprintf(
             "Maintain a full address index, used to query for the balance, txids and unspent outputs for addresses (default: %u)",
             DEFAULT_ADDRESSINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::INDEXING);
@@ -597,6 +640,12 @@ void SetupServerArgs() {
     gArgs.AddArg("-txindex",
                  strprintf("Maintain a full transaction index, used by the getrawtransaction rpc call (default: %u)",
                            DEFAULT_TXINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::INDEXING);
+    gArgs.AddArg("-blockfilterindex=<type>",
+                 strprintf(
+                         "Maintain an index of compact filters by block (default: %s, values: %s).", DEFAULT_BLOCKFILTERINDEX,
+                         ListBlockFilterTypes()) +
+                 " If <type> is not supplied or if <type> = 1, indexes for all known types are enabled.",
+                 ArgsManager::ALLOW_ANY, OptionsCategory::INDEXING);
     gArgs.AddArg("-futureindex",
                  strprintf("Maintain a full future index, used to query future transactions (default: %u)",
                            DEFAULT_FUTUREINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::INDEXING);
@@ -653,12 +702,18 @@ void SetupServerArgs() {
     gArgs.AddArg("-maxuploadtarget=<n>", strprintf(
             "Tries to keep outbound traffic under the given target (in MiB per 24h), 0 = no limit (default: %d)",
             DEFAULT_MAX_UPLOAD_TARGET), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
+    gArgs.AddArg("-msghandthreads=<n>", strprintf(
+            "Number of threads processing peer messages, each peer is handled by one of them (1 to %d, default: %d)",
+            MAX_MSGHAND_THREADS, DEFAULT_MSGHAND_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     gArgs.AddArg("-onion=<ip:port>",
                  "Use separate SOCKS5 proxy to reach peers via Tor hidden services (default: -proxy)",
                  ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     gArgs.AddArg("-onlynet=<net>",
                  "Make outgoing connections only through network <net> (ipv4, ipv6 or onion). Incoming connections are not affected by this option. This option can be specified multiple times to allow multiple networks.",
                  ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
+    gArgs.AddArg("-peerblockfilters",
+                 strprintf("Serve compact block filters to peers per BIP 157 (default: %u)", DEFAULT_PEERBLOCKFILTERS),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     gArgs.AddArg("-peerbloomfilters",
                  strprintf("Support filtering of blocks and transaction with bloom filters (default: %u)",
                            DEFAULT_PEERBLOOMFILTERS), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
@@ -718,6 +773,11 @@ void SetupServerArgs() {
     g_wallet_init_interface.AddWalletOptions();
 
 #if ENABLE_ZMQ
+    gArgs.AddArg("-zmqpubassetcreate=<address>", "Enable publish asset creations in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubassetmint=<address>", "Enable publish asset mints in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubassettransfer=<address>", "Enable publish asset transfers in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubassetupdate=<address>", "Enable publish asset updates in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubfuturematured=<address>", "Enable publish future outputs becoming spendable in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     gArgs.AddArg("-zmqpubhashblock=<address>", "Enable publish hash block in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     gArgs.AddArg("-zmqpubhashchainlock=<address>", "Enable publish hash block (locked via ChainLocks) in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     gArgs.AddArg("-zmqpubhashgovernanceobject=<address>", "Enable publish hash of governance objects (like proposals) in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
@@ -734,7 +794,13 @@ void SetupServerArgs() {
     gArgs.AddArg("-zmqpubrawtx=<address>", "Enable publish raw transaction in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     gArgs.AddArg("-zmqpubrawtxlock=<address>", "Enable publish raw transaction (locked via InstantSend) in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     gArgs.AddArg("-zmqpubrawtxlocksig=<address>", "Enable publish raw transaction (locked via InstantSend) and ISLOCK in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubqueuesize=<n>", strprintf("Send published messages from a background thread, queuing up to <n> MiB of them for slow subscribers before dropping messages (0 to send synchronously, default: %u)", DEFAULT_ZMQ_PUBLISH_QUEUE_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
 #else
+    hidden_args.emplace_back("-zmqpubassetcreate=<address>");
+    hidden_args.emplace_back("-zmqpubassetmint=<address>");
+    hidden_args.emplace_back("-zmqpubassettransfer=<address>");
+    hidden_args.emplace_back("-zmqpubassetupdate=<address>");
+    hidden_args.emplace_back("-zmqpubfuturematured=<address>");
     hidden_args.emplace_back("-zmqpubhashblock=<address>");
     hidden_args.emplace_back("-zmqpubhashchainlock=<address>");
     hidden_args.emplace_back("-zmqpubhashgovernanceobject=<address>");
@@ -751,6 +817,7 @@ void SetupServerArgs() {
     hidden_args.emplace_back("-zmqpubrawtx=<address>");
     hidden_args.emplace_back("-zmqpubrawtxlock=<address>");
     hidden_args.emplace_back("-zmqpubrawtxlocksig=<address>");
+    hidden_args.emplace_back("-zmqpubqueuesize=<n>");
 #endif
 
     gArgs.AddArg("-checkblockindex", strprintf(
@@ -821,6 +888,9 @@ void SetupServerArgs() {
                  ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-help-debug", "Print help message with debugging options and exit", ArgsManager::ALLOW_ANY,
                  OptionsCategory::DEBUG_TEST);
+    gArgs.AddArg("-logasync", strprintf(
+            "Write debug output from a background thread, threads logging never wait for the disk. Messages logged while %u are waiting to be written are dropped (default: %u)",
+            BCLog::LOG_ASYNC_QUEUE_SIZE, DEFAULT_LOGASYNC), ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-logips", strprintf("Include IP addresses in debug output (default: %u)", DEFAULT_LOGIPS),
                  ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-logtimemicros",
@@ -924,9 +994,30 @@ void SetupServerArgs() {
                  OptionsCategory::BLOCK_CREATION);
     gArgs.AddArg("-blockversion=<n>", "Override block version to test forking scenarios",
                  ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::BLOCK_CREATION);
+    gArgs.AddArg("-stratum", strprintf(
+            "Accept stratum miners, pushing them new work on tip and mempool changes and submitting their blocks (default: %u)",
+            DEFAULT_STRATUM_ENABLE), ArgsManager::ALLOW_ANY, OptionsCategory::BLOCK_CREATION);
+    gArgs.AddArg("-stratumaddress=<addr>", "Address receiving the reward of blocks mined by stratum miners",
+                 ArgsManager::ALLOW_ANY, OptionsCategory::BLOCK_CREATION);
+    gArgs.AddArg("-stratumbind=<addr>[:port]", strprintf(
+            "Bind the stratum server to given address, miners are not authenticated (default: %s)",
+            DEFAULT_STRATUM_BIND), ArgsManager::ALLOW_ANY | ArgsManager::NETWORK_ONLY, OptionsCategory::BLOCK_CREATION);
+    gArgs.AddArg("-stratumdifficulty=<n>", strprintf("Share difficulty of stratum miners (default: %s)",
+                                                     ToString(DEFAULT_STRATUM_DIFFICULTY)),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::BLOCK_CREATION);
+    gArgs.AddArg("-stratumjobinterval=<n>", strprintf(
+            "Seconds between new stratum jobs when only the mempool changed (default: %u)",
+            DEFAULT_STRATUM_JOB_INTERVAL), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY,
+                 OptionsCategory::BLOCK_CREATION);
+    gArgs.AddArg("-stratumport=<port>", strprintf("Listen for stratum miners on <port> (default: %u)",
+                                                  DEFAULT_STRATUM_PORT),
+                 ArgsManager::ALLOW_ANY | ArgsManager::NETWORK_ONLY, OptionsCategory::BLOCK_CREATION);
 
     gArgs.AddArg("-rest", strprintf("Accept public REST requests (default: %u)", DEFAULT_REST_ENABLE),
                  ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
+    gArgs.AddArg("-metrics",
+                 strprintf("Serve the internal metrics in the Prometheus text format on /metrics of the RPC port, without authentication (default: %u)",
+                           DEFAULT_HTTP_METRICS_ENABLE), ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     gArgs.AddArg("-rpcallowip=<ip>",
                  "Allow JSON-RPC connections from specified source. Valid for <ip> are a single IP (e.g. 1.2.3.4), a network/netmask (e.g. 1.2.3.4/255.255.255.0) or a network/CIDR (e.g. 1.2.3.4/24). This option can be specified multiple times",
                  ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
@@ -959,6 +1050,9 @@ void SetupServerArgs() {
 
     gArgs.AddArg("-statsenabled", strprintf("Publish internal stats to statsd (default: %u)", DEFAULT_STATSD_ENABLE),
                  ArgsManager::ALLOW_ANY, OptionsCategory::STATSD);
+    gArgs.AddArg("-statsflushinterval=<ms>",
+                 strprintf("Aggregate stats in memory and send them in batches every <ms> milliseconds, 0 sends every stat right away (default: %d)",
+                           DEFAULT_STATSD_FLUSH_INTERVAL), ArgsManager::ALLOW_ANY, OptionsCategory::STATSD);
     gArgs.AddArg("-statshost=<ip>", strprintf("Specify statsd host (default: %s)", DEFAULT_STATSD_HOST),
                  ArgsManager::ALLOW_ANY, OptionsCategory::STATSD);
     gArgs.AddArg("-statshostname=<ip>", strprintf("Specify statsd host name (default: %s)", DEFAULT_STATSD_HOSTNAME),
@@ -1283,6 +1377,8 @@ static bool AppInitServers(const util::Ref &context, NodeContext &node) {
         return false;
     if (gArgs.GetBoolArg("-rest", DEFAULT_REST_ENABLE) && !StartREST(context))
         return false;
+    if (gArgs.GetBoolArg("-metrics", DEFAULT_HTTP_METRICS_ENABLE))
+        StartHTTPMetrics();
     StartHTTPServer();
     return true;
 }
@@ -1418,6 +1514,7 @@ void InitLogging() {
     LogInstance().m_log_threadnames = gArgs.GetBoolArg("-logthreadnames", DEFAULT_LOGTHREADNAMES);
 #endif
     LogInstance().m_log_sourcelocations = gArgs.GetBoolArg("-logsourcelocations", DEFAULT_LOGSOURCELOCATIONS);
+    LogInstance().m_async = gArgs.GetBoolArg("-logasync", DEFAULT_LOGASYNC);
 
     fLogIPs = gArgs.GetBoolArg("-logips", DEFAULT_LOGIPS);
 
@@ -1508,10 +1605,28 @@ bool AppInitParameterInteraction() {
                 strprintf(_("Specified blocks directory \"%s\" does not exist."), gArgs.GetArg("-blocksdir", "")));
     }
 
+    // parse and validate enabled filter types
+    std::string blockfilterindex_value = gArgs.GetArg("-blockfilterindex", DEFAULT_BLOCKFILTERINDEX);
+    if (blockfilterindex_value == "" || blockfilterindex_value == "1") {
+        g_enabled_filter_types = AllBlockFilterTypes();
+    } else if (blockfilterindex_value != "0") {
+        const std::vector <std::string> names = gArgs.GetArgs("-blockfilterindex");
+        for (const auto &name: names) {
+            BlockFilterType filter_type;
+            if (!BlockFilterTypeByName(name, filter_type)) {
+                return InitError(strprintf(_("Unknown -blockfilterindex value %s."), name));
+            }
+            g_enabled_filter_types.insert(filter_type);
+        }
+    }
+
     // if using block pruning, then disallow txindex and require disabling governance validation
     if (gArgs.GetArg("-prune", 0)) {
         if (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX))
             return InitError(_("Prune mode is incompatible with -txindex."));
+        if (!g_enabled_filter_types.empty()) {
+            return InitError(_("Prune mode is incompatible with -blockfilterindex."));
+        }
         if (!gArgs.GetBoolArg("-disablegovernance", false)) {
             return InitError(_("Prune mode is incompatible with -disablegovernance=false."));
         }
@@ -1715,6 +1830,14 @@ bool AppInitParameterInteraction() {
     if (gArgs.GetBoolArg("-peerbloomfilters", DEFAULT_PEERBLOOMFILTERS))
         nLocalServices = ServiceFlags(nLocalServices | NODE_BLOOM);
 
+    // Signal NODE_COMPACT_FILTERS if peerblockfilters and basic filters index are both enabled.
+    if (gArgs.GetBoolArg("-peerblockfilters", DEFAULT_PEERBLOCKFILTERS)) {
+        if (g_enabled_filter_types.count(BlockFilterType::BASIC_FILTER) != 1) {
+            return InitError(_("Cannot set -peerblockfilters without -blockfilterindex."));
+        }
+        nLocalServices = ServiceFlags(nLocalServices | NODE_COMPACT_FILTERS);
+    }
+
     nMaxTipAge = gArgs.GetArg("-maxtipage", DEFAULT_MAX_TIP_AGE);
 
     if (gArgs.IsArgSet("-smartnodeblsprivkey")) {
@@ -1963,6 +2086,7 @@ bool AppInitMain(const util::Ref &context, NodeContext &node, interfaces::BlockA
     assert(!node.chainman);
     node.chainman = &g_chainman;
     ChainstateManager &chainman = EnsureChainman(node);
+    node.template_builder = MakeUnique<BlockTemplateBuilder>(*node.mempool, chainparams);
 
     node.peer_logic.reset(
             new PeerLogicValidation(node.connman.get(), node.banman.get(), *node.scheduler, *node.chainman,
@@ -2100,30 +2224,25 @@ bool AppInitMain(const util::Ref &context, NodeContext &node, interfaces::BlockA
 
     // ********************************************************* Step 7a: Load sporks
 
+    // Cache files are read and verified while the block chain is loaded, they're deserialized in step 10b
+    auto futureMnCache = ReadCacheFileAsync<CSmartnodeMetaMan>("mncache.dat", "magicSmartnodeCache");
+    auto futureNetFulfilled = ReadCacheFileAsync<CNetFulfilledRequestManager>("netfulfilled.dat", "magicFulfilledCache");
+    auto futurePowCache = ReadCacheFileAsync<CPowCache>("powcache.dat", "powCache");
+    std::future<CFlatDB<CGovernanceManager>::Payload> futureGovernance;
+    if (!fDisableGovernance) {
+        futureGovernance = ReadCacheFileAsync<CGovernanceManager>("governance.dat", "magicGovernanceCache");
+    }
+
     uiInterface.InitMessage(_("Loading sporks cache..."));
     CFlatDB <CSporkManager> flatdb6("sporks.dat", "magicSporkCache");
     if (!flatdb6.Load(sporkManager)) {
         return InitError(_("Failed to load sporks cache from") + "\n" + (GetDataDir() / "sporks.dat").string());
     }
 
-    // ********************************************************* Step 7b: load powcache.dat
-    {
-        fs::path pathDB = GetDataDir();
-        std::string strDBName = "powcache.dat";
+    // ********************************************************* Step 7b: start loading powcache.dat
 
-        LOCK(cs_pow);
-        // Always load the powcache if available:
-        uiInterface.InitMessage(_("Loading POW cache..."));
-        fs::path powCacheFile = pathDB / strDBName;
-        if (!fs::exists(powCacheFile)) {
-            uiInterface.InitMessage("Loading POW cache for the first time. This could take a minute...");
-        }
-
-        CFlatDB <CPowCache> flatdb7(strDBName, "powCache");
-        if (!flatdb7.Load(CPowCache::Instance())) {
-            return InitError(_("Failed to load POW cache from") + "\n" + (pathDB / strDBName).string());
-        }
-    }
+    // Hashes computed until powcache.dat is merged in step 10b are cached as usual, but not dumped
+    CPowCache::Instance().StartLoading();
 
     // ********************************************************* Step 7c: load block chain
 
@@ -2139,6 +2258,13 @@ bool AppInitMain(const util::Ref &context, NodeContext &node, interfaces::BlockA
     int64_t nTxIndexCache = std::min(nTotalCache / 8,
                                      gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX) ? nMaxTxIndexCache << 20 : 0);
     nTotalCache -= nTxIndexCache;
+    int64_t filter_index_cache = 0;
+    if (!g_enabled_filter_types.empty()) {
+        size_t n_indexes = g_enabled_filter_types.size();
+        int64_t max_cache = std::min(nTotalCache / 8, nMaxFilterIndexCache << 20);
+        filter_index_cache = max_cache / n_indexes;
+        nTotalCache -= filter_index_cache * n_indexes;
+    }
     int64_t nCoinDBCache = std::min(nTotalCache / 2,
                                     (nTotalCache / 4) + (1 << 23)); // use 25%-50% of the remainder for disk cache
     nCoinDBCache = std::min(nCoinDBCache, nMaxCoinsDBCache << 20); // cap total coins db cache
@@ -2151,6 +2277,10 @@ bool AppInitMain(const util::Ref &context, NodeContext &node, interfaces::BlockA
     if (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
         LogPrintf("* Using %.1fMiB for transaction index database\n", nTxIndexCache * (1.0 / 1024 / 1024));
     }
+    for (BlockFilterType filter_type: g_enabled_filter_types) {
+        LogPrintf("* Using %.1fMiB for %s block filter index database\n",
+                  filter_index_cache * (1.0 / 1024 / 1024), BlockFilterTypeName(filter_type));
+    }
     LogPrintf("* Using %.1fMiB for chain state database\n", nCoinDBCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for in-memory UTXO set (plus up to %.1fMiB of unused mempool space)\n",
               nCoinCacheUsage * (1.0 / 1024 / 1024), nMempoolSizeMax * (1.0 / 1024 / 1024));
@@ -2441,12 +2571,23 @@ bool AppInitMain(const util::Ref &context, NodeContext &node, interfaces::BlockA
         ::feeEstimator.Read(est_filein);
     fFeeEstimatesInitialized = true;
 
+#if ENABLE_ZMQ
+    if (g_zmq_notification_interface) {
+        g_zmq_notification_interface->SeedFutureTracker();
+    }
+#endif
+
     // ********************************************************* Step 8: start indexers
     if (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
         g_txindex = MakeUnique<TxIndex>(nTxIndexCache, false, fReindex);
         g_txindex->Start();
     }
 
+    for (const auto &filter_type: g_enabled_filter_types) {
+        InitBlockFilterIndex(filter_type, filter_index_cache, false, fReindex);
+        GetBlockFilterIndex(filter_type)->Start();
+    }
+
     // ********************************************************* Step 9: load wallet
     for (const auto &client: node.chain_clients) {
         if (!client->load()) {
@@ -2535,8 +2676,9 @@ bool AppInitMain(const util::Ref &context, NodeContext &node, interfaces::BlockA
     strDBName = "mncache.dat";
     uiInterface.InitMessage(_("Loading smartnode cache..."));
     CFlatDB <CSmartnodeMetaMan> flatdb1(strDBName, "magicSmartnodeCache");
+    auto mnCachePayload = futureMnCache.get();
     if (fLoadCacheFiles) {
-        if (!flatdb1.Load(mmetaman)) {
+        if (!flatdb1.Load(mmetaman, mnCachePayload)) {
             return InitError(_("Failed to load smartnode cache from") + "\n" + (pathDB / strDBName).string());
         }
     } else {
@@ -2546,14 +2688,25 @@ bool AppInitMain(const util::Ref &context, NodeContext &node, interfaces::BlockA
         }
     }
 
+    // Governance objects are deserialized and checked in the background, see CGovernanceManager::StartLoading
     strDBName = "governance.dat";
     uiInterface.InitMessage(_("Loading governance cache..."));
     CFlatDB <CGovernanceManager> flatdb3(strDBName, "magicGovernanceCache");
     if (fLoadCacheFiles && !fDisableGovernance) {
-        if (!flatdb3.Load(governance)) {
+        auto governancePayload = std::make_shared<CFlatDB<CGovernanceManager>::Payload>(futureGovernance.get());
+        if (!flatdb3.CheckReadResult(governancePayload->result)) {
             return InitError(_("Failed to load governance cache from") + "\n" + (pathDB / strDBName).string());
         }
-        governance.InitOnLoad();
+        governance.StartLoading();
+        CConnman &connman = *node.connman;
+        threadGroup.create_thread(std::bind(&TraceThread<std::function<void()>>, "govload", [governancePayload, &connman] {
+            CFlatDB <CGovernanceManager> flatdb("governance.dat", "magicGovernanceCache");
+            if (governancePayload->result == CFlatDB<CGovernanceManager>::Ok) {
+                flatdb.Load(governance, *governancePayload);
+            }
+            governance.InitOnLoad();
+            governance.FinishLoading(connman);
+        }));
     } else {
         CGovernanceManager governanceTmp;
         if (!flatdb3.Dump(governanceTmp)) {
@@ -2564,8 +2717,9 @@ bool AppInitMain(const util::Ref &context, NodeContext &node, interfaces::BlockA
     strDBName = "netfulfilled.dat";
     uiInterface.InitMessage(_("Loading fulfilled requests cache..."));
     CFlatDB <CNetFulfilledRequestManager> flatdb4(strDBName, "magicFulfilledCache");
+    auto netFulfilledPayload = futureNetFulfilled.get();
     if (fLoadCacheFiles) {
-        if (!flatdb4.Load(netfulfilledman)) {
+        if (!flatdb4.Load(netfulfilledman, netFulfilledPayload)) {
             return InitError(_("Failed to load fulfilled requests cache from") + "\n" + (pathDB / strDBName).string());
         }
     } else {
@@ -2575,6 +2729,22 @@ bool AppInitMain(const util::Ref &context, NodeContext &node, interfaces::BlockA
         }
     }
 
+    // The POW cache is always loaded, it's merged in the background
+    strDBName = "powcache.dat";
+    uiInterface.InitMessage(_("Loading POW cache..."));
+    CFlatDB <CPowCache> flatdb7(strDBName, "powCache");
+    auto powCachePayload = std::make_shared<CFlatDB<CPowCache>::Payload>(futurePowCache.get());
+    if (!flatdb7.CheckReadResult(powCachePayload->result)) {
+        return InitError(_("Failed to load POW cache from") + "\n" + (pathDB / strDBName).string());
+    }
+    threadGroup.create_thread(std::bind(&TraceThread<std::function<void()>>, "powload", [powCachePayload] {
+        CPowCache powCacheLoaded(CPowCache::Instance().getMaxSize(), CPowCache::Instance().IsValidate());
+        if (powCachePayload->result == CFlatDB<CPowCache>::Ok) {
+            CFlatDB<CPowCache>("powcache.dat", "powCache").Load(powCacheLoaded, *powCachePayload);
+        }
+        CPowCache::Instance().FinishLoading(powCacheLoaded);
+    }));
+
     // ********************************************************* Step 10c: schedule 405Coin-specific tasks
 
     node.scheduler->scheduleEvery(std::bind(&CNetFulfilledRequestManager::DoMaintenance, std::ref(netfulfilledman)),
@@ -2609,6 +2779,7 @@ bool AppInitMain(const util::Ref &context, NodeContext &node, interfaces::BlockA
                 std::max((int) gArgs.GetArg("-statsperiod", DEFAULT_STATSD_PERIOD), MIN_STATSD_PERIOD),
                 MAX_STATSD_PERIOD);
         node.scheduler->scheduleEvery(PeriodicStats, nStatsPeriod * 1000);
+        statsClient.StartFlushThread(gArgs.GetArg("-statsflushinterval", DEFAULT_STATSD_FLUSH_INTERVAL));
     }
 
     llmq::StartLLMQSystem();
@@ -2688,6 +2859,10 @@ bool AppInitMain(const util::Ref &context, NodeContext &node, interfaces::BlockA
     if (gArgs.GetBoolArg("-listenonion", DEFAULT_LISTEN_ONION))
         StartTorControl();
 
+    if (!StartStratum(node)) {
+        return false;
+    }
+
     Discover();
 
     // Map ports with UPnP
@@ -2706,6 +2881,7 @@ bool AppInitMain(const util::Ref &context, NodeContext &node, interfaces::BlockA
     connOptions.nSendBufferMaxSize = 1000 * gArgs.GetArg("-maxsendbuffer", DEFAULT_MAXSENDBUFFER);
     connOptions.nReceiveFloodSize = 1000 * gArgs.GetArg("-maxreceivebuffer", DEFAULT_MAXRECEIVEBUFFER);
     connOptions.m_added_nodes = gArgs.GetArgs("-addnode");
+    connOptions.nMsgHandThreads = gArgs.GetArg("-msghandthreads", DEFAULT_MSGHAND_THREADS);
 
     connOptions.nMaxOutboundLimit = 1024 * 1024 * gArgs.GetArg("-maxuploadtarget", DEFAULT_MAX_UPLOAD_TARGET);
     connOptions.m_peer_connect_timeout = peer_connect_timeout;
@@ -5,12 +5,15 @@
 
 #include <interfaces/chain.h>
 
+#include <blockfilter.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <coinjoin/coinjoin.h>
+#include <index/blockfilterindex.h>
 #include <interfaces/handler.h>
 #include <interfaces/wallet.h>
 #include <net.h>
+#include <node/blockprefetch.h>
 #include <node/coin.h>
 #include <node/context.h>
 #include <node/transaction.h>
@@ -34,6 +37,7 @@
 #include <validation.h>
 #include <validationinterface.h>
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 
@@ -141,6 +145,32 @@ namespace interfaces {
             const CRPCCommand *m_wrapped_command;
         };
 
+        class BlockReaderImpl : public Chain::BlockReader {
+        public:
+            BlockReaderImpl(const std::vector<const CBlockIndex *> &blocks, int threads)
+            EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+                    : m_prefetcher(blocks, Params().GetConsensus(), threads) {
+                for (const CBlockIndex *index: blocks) {
+                    m_hashes.push_back(index->GetBlockHash());
+                }
+            }
+
+            std::shared_ptr<const CBlock> next(const uint256 &hash) override {
+                auto it = std::find(m_hashes.begin() + m_next, m_hashes.end(), hash);
+                if (it == m_hashes.end()) return nullptr;
+                std::shared_ptr<const CBlock> block;
+                FlatFilePos pos;
+                for (const size_t end = it - m_hashes.begin() + 1; m_next < end; m_next++) {
+                    if (!m_prefetcher.Next(block, pos)) return nullptr;
+                }
+                return block;
+            }
+
+            std::vector<uint256> m_hashes;
+            size_t m_next{0};
+            CBlockPrefetcher m_prefetcher;
+        };
+
         class ChainImpl : public Chain {
         public:
             explicit ChainImpl(NodeContext &node) : m_node(node) {}
@@ -270,6 +300,38 @@ namespace interfaces {
                 return true;
             }
 
+            std::unique_ptr<BlockReader> readBlocksAhead(const std::vector<uint256> &hashes) override {
+                const int threads = GetBlockPrefetchThreads();
+                if (threads == 0 || hashes.size() < 2) return nullptr;
+                LOCK(cs_main);
+                std::vector<const CBlockIndex *> blocks;
+                for (const uint256 &hash: hashes) {
+                    const CBlockIndex *index = LookupBlockIndex(hash);
+                    if (!index || !(index->nStatus & BLOCK_HAVE_DATA)) break;
+                    blocks.push_back(index);
+                }
+                if (blocks.empty()) return nullptr;
+                return MakeUnique<BlockReaderImpl>(blocks, threads);
+            }
+
+            bool hasBlockFilterIndex(BlockFilterType filter_type) override {
+                return GetBlockFilterIndex(filter_type) != nullptr;
+            }
+
+            Optional<std::vector<bool>> blockFiltersMatchAny(BlockFilterType filter_type, int start_height,
+                                                             const uint256 &stop_hash,
+                                                             const GCSFilter::ElementSet &elements) override {
+                BlockFilterIndex *index = GetBlockFilterIndex(filter_type);
+                if (!index) return nullopt;
+
+                const CBlockIndex *stop_index = WITH_LOCK(cs_main, return LookupBlockIndex(stop_hash));
+                std::vector<BlockFilter> filters;
+                if (!stop_index || !index->LookupFilterRange(start_height, stop_index, filters)) {
+                    return nullopt;
+                }
+                return BlockFiltersMatchAny(filters, elements, GetNumCores());
+            }
+
             void findCoins(std::map <COutPoint, Coin> &coins) override { return FindCoins(m_node, coins); }
 
             double guessVerificationProgress(const uint256 &block_hash) override {
@@ -6,6 +6,7 @@
 #ifndef BITCOIN_INTERFACES_CHAIN_H
 #define BITCOIN_INTERFACES_CHAIN_H
 
+#include <blockfilter.h>            // For BlockFilterType and GCSFilter
 #include <optional.h>               // For Optional and nullopt
 #include <primitives/transaction.h> // For CTransactionRef
 
@@ -145,6 +146,32 @@ namespace interfaces {
                                int64_t *time = nullptr,
                                int64_t *max_time = nullptr) = 0;
 
+        //! Blocks read ahead on background threads, in the order they are going
+        //! to be requested.
+        class BlockReader {
+        public:
+            virtual ~BlockReader() {}
+
+            //! Return the block with this hash, skipping the blocks read ahead
+            //! before it. nullptr if it isn't read ahead or couldn't be read.
+            virtual std::shared_ptr<const CBlock> next(const uint256 &hash) = 0;
+        };
+
+        //! Start reading these blocks ahead, up to the first one without data.
+        //! nullptr if blocks aren't read ahead.
+        virtual std::unique_ptr <BlockReader> readBlocksAhead(const std::vector <uint256> &hashes) = 0;
+
+        //! Return whether a block filter index of this type is enabled.
+        virtual bool hasBlockFilterIndex(BlockFilterType filter_type) = 0;
+
+        //! Match the filters of the blocks from start_height up to and including
+        //! stop_hash (following its chain) against the elements, entry i is for
+        //! the block at start_height + i. Returns nullopt if a filter isn't
+        //! indexed yet.
+        virtual Optional<std::vector<bool>> blockFiltersMatchAny(BlockFilterType filter_type, int start_height,
+                                                                 const uint256 &stop_hash,
+                                                                 const GCSFilter::ElementSet &elements) = 0;
+
         //! Look up unspent output information. Returns coins in the mempool and in
         //! the current chain UTXO set. Iterates through all the keys in the map and
         //! populates the values.
@@ -374,13 +374,19 @@ namespace llmq {
             vvecs.emplace_back(receivedVvecs[idx]);
             skContributions.emplace_back(receivedSkContributions[idx]);
             voteVersions.emplace_back(receivedVersions[idx]);
+        }
+
+        // Let the workers verify while we're busy writing to disk
+        auto resultFuture = blsWorker.AsyncVerifyContributionShares(myId, vvecs, skContributions, true, true);
+
+        for (const auto &idx: memberIndexes) {
             // Write here to definitely store one contribution for each member no matter if
             // our share is valid or not, could be that others are still correct
-            dkgManager.WriteEncryptedContributions(params.type, m_quorum_base_block_index, m->dmn->proTxHash,
+            dkgManager.WriteEncryptedContributions(params.type, m_quorum_base_block_index, members[idx]->dmn->proTxHash,
                                                    *vecEncryptedContributions[idx]);
         }
 
-        auto result = blsWorker.VerifyContributionShares(myId, vvecs, skContributions);
+        auto result = resultFuture.get();
         if (result.size() != memberIndexes.size()) {
             logger.Batch(
                     "VerifyContributionShares returned result of size %d but size %d was expected, something is wrong",
@@ -969,20 +975,27 @@ namespace llmq {
             return;
         }
 
-        BLSVerificationVectorPtr vvec = cache.BuildQuorumVerificationVector(::SerializeHash(memberIndexes), vvecs);
+        // Build the quorum vvec and our secret key share at the same time, both futures must be waited for as they
+        // reference vvecs and skContributions
+        const uint256 cacheKey = ::SerializeHash(memberIndexes);
+        auto vvecFuture = cache.AsyncBuildQuorumVerificationVector(cacheKey, vvecs);
+        auto skShareFuture = cache.AsyncAggregateSecretKeys(cacheKey, skContributions);
+
+        BLSVerificationVectorPtr vvec = vvecFuture.get();
+        t1.stop();
+
+        cxxtimer::Timer t2(true);
+        CBLSSecretKey skShare = skShareFuture.get();
+        t2.stop();
+
         if (vvec == nullptr) {
             logger.Batch("failed to build quorum verification vector");
             return;
         }
-        t1.stop();
-
-        cxxtimer::Timer t2(true);
-        CBLSSecretKey skShare = cache.AggregateSecretKeys(::SerializeHash(memberIndexes), skContributions);
         if (!skShare.IsValid()) {
             logger.Batch("failed to build own secret share");
             return;
         }
-        t2.stop();
 
         logger.Batch("pubKeyShare=%s", skShare.GetPublicKey().ToString());
 
@@ -19,6 +19,7 @@
 #include <util/ranges.h>
 #include <smartnode/smartnode-sync.h>
 #include <net_processing.h>
+#include <metrics.h>
 #include <spork.h>
 #include <validation.h>
 #include <util/validation.h>
@@ -804,6 +805,10 @@ namespace llmq {
                  __func__,
                  islock->txid.ToString(), hash.ToString(), pfrom->GetId());
 
+        static auto &counterReceived = metrics::GetRegistry().GetCounter("llmq_islocks_received",
+                                                                         "Number of new ISLOCKs received from peers");
+        counterReceived.Inc();
+
         LOCK(cs_pendingLocks);
         pendingInstantSendLocks.emplace(hash, std::make_pair(pfrom->GetId(), islock));
     }
@@ -951,6 +956,9 @@ namespace llmq {
         cxxtimer::Timer verifyTimer(true);
         batchVerifier.Verify();
         verifyTimer.stop();
+        static auto &histVerify = metrics::GetRegistry().GetHistogram("llmq_islock_batch_verify_ms",
+                                                                      "Time to verify a batch of ISLOCK signatures");
+        histVerify.Observe(verifyTimer.count<std::chrono::microseconds>() * 0.001);
 
         LogPrint(BCLog::INSTANTSEND,
                  "CInstantSendManager::%s -- verified locks. count=%d, alreadyVerified=%d, vt=%d, nodes=%d\n", __func__,
@@ -979,7 +987,12 @@ namespace llmq {
                 continue;
             }
 
-            ProcessInstantSendLock(nodeId, hash, islock);
+            {
+                static auto &histProcess = metrics::GetRegistry().GetHistogram("llmq_islock_process_ms",
+                                                                               "Time to process a verified ISLOCK");
+                metrics::HistogramTimer timer(histProcess);
+                ProcessInstantSendLock(nodeId, hash, islock);
+            }
 
             // See comment further on top. We pass a reconstructed recovered sig to the signing manager to avoid
             // double-verification of the sig.
@@ -14,6 +14,7 @@
 #include <bls/bls_batchverifier.h>
 #include <chainparams.h>
 #include <cxxtimer.hpp>
+#include <hash.h>
 #include <net_processing.h>
 #include <netmessagemaker.h>
 #include <scheduler.h>
@@ -37,6 +38,170 @@ namespace llmq {
         return ret;
     }
 
+    void CRecoveredSigsFilter::Reset(size_t _nCapacity) {
+        nCapacity = _nCapacity;
+        vBits.assign(std::max<size_t>(1, (nCapacity * BITS_PER_ELEMENT + 63) / 64), 0);
+        nBits = vBits.size() * 64;
+        nElements = 0;
+    }
+
+    void CRecoveredSigsFilter::Insert(uint64_t hash) {
+        // double hashing, see Kirsch and Mitzenmacher, "Less Hashing, Same Performance"
+        uint32_t h1 = (uint32_t) hash;
+        uint32_t h2 = (uint32_t)(hash >> 32);
+        for (uint32_t i = 0; i < HASH_FUNCS; i++) {
+            uint64_t bit = ((uint64_t)(uint32_t)(h1 + i * h2) * nBits) >> 32;
+            vBits[bit >> 6] |= (uint64_t) 1 << (bit & 63);
+        }
+        nElements++;
+    }
+
+    bool CRecoveredSigsFilter::MaybeContains(uint64_t hash) const {
+        uint32_t h1 = (uint32_t) hash;
+        uint32_t h2 = (uint32_t)(hash >> 32);
+        for (uint32_t i = 0; i < HASH_FUNCS; i++) {
+            uint64_t bit = ((uint64_t)(uint32_t)(h1 + i * h2) * nBits) >> 32;
+            if (!(vBits[bit >> 6] & ((uint64_t) 1 << (bit & 63)))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t CRecoveredSigsFilter::DynamicMemoryUsage() const {
+        return memusage::DynamicUsage(vBits);
+    }
+
+    UniValue CRecoveredSigsCacheStats::ToJson() const {
+        UniValue ret(UniValue::VOBJ);
+        ret.pushKV("cacheHits", nCacheHits);
+        ret.pushKV("filterNegatives", nFilterNegatives);
+        ret.pushKV("dbReads", nDbReads);
+        ret.pushKV("falsePositives", nFalsePositives);
+        ret.pushKV("filterRebuilds", nFilterRebuilds);
+        ret.pushKV("filterElements", (uint64_t) nFilterElements);
+        ret.pushKV("filterCapacity", (uint64_t) nFilterCapacity);
+        ret.pushKV("cacheEntries", (uint64_t) nCacheEntries);
+        ret.pushKV("cacheMaxEntries", (uint64_t) nCacheMaxEntries);
+        ret.pushKV("memoryUsage", (uint64_t) nMemoryUsage);
+        return ret;
+    }
+
+    CRecoveredSigsDb::CRecoveredSigsDb(bool fMemory, bool fWipe) :
+            db(std::make_unique<CDBWrapper>(fMemory ? "" : (GetDataDir() / "llmq/recsigdb"), 8 << 20, fMemory, fWipe)),
+            hasSigForIdCache(GetCacheEntriesLimit()),
+            hasSigForSessionCache(GetCacheEntriesLimit()),
+            hasSigForHashCache(GetCacheEntriesLimit()) {
+        MigrateRecoveredSigs();
+
+        LOCK(cs);
+        RebuildFilters();
+    }
+
+    size_t CRecoveredSigsDb::GetCacheEntriesLimit() {
+        int64_t nCacheSize = std::max<int64_t>(1, gArgs.GetArg("-recsigcache", DEFAULT_RECOVERED_SIGS_CACHE_SIZE)) << 20;
+        // the budget is shared by all three caches, each of which may grow to twice its size before being truncated
+        size_t nEntryUsage = std::max({decltype(hasSigForIdCache)::EntryMemoryUsage(),
+                                       decltype(hasSigForSessionCache)::EntryMemoryUsage(),
+                                       decltype(hasSigForHashCache)::EntryMemoryUsage()});
+        return std::max<size_t>(1, nCacheSize / (3 * 2 * nEntryUsage));
+    }
+
+    void CRecoveredSigsDb::RebuildFilters() {
+        AssertLockHeld(cs);
+
+        cxxtimer::Timer timer(true);
+
+        std::vector <uint64_t> vIds, vSessions, vHashes;
+        std::unique_ptr <CDBIterator> pcursor(db->NewIterator());
+
+        // "rs_r" holds both the (llmqType, id) -> recSig entries and the (llmqType, id, msgHash) -> time entries,
+        // only the former are of interest here
+        auto start_r = std::make_tuple(std::string("rs_r"), (Consensus::LLMQType) 0, uint256());
+        pcursor->Seek(start_r);
+        while (pcursor->Valid()) {
+            decltype(start_r)
+            k;
+            try {
+                CDataStream ssKey = pcursor->GetKey();
+                ssKey >> k;
+                if (std::get<0>(k) != "rs_r") {
+                    break;
+                }
+                if (ssKey.empty()) {
+                    vIds.emplace_back(SipHashUint256Extra(filterK0, filterK1, std::get<2>(k), (uint32_t) std::get<1>(k)));
+                }
+            } catch (const std::exception &) {
+                break;
+            }
+            pcursor->Next();
+        }
+
+        auto scanHashes = [&](const std::string &prefix, std::vector <uint64_t> &vRet) {
+            auto start = std::make_tuple(prefix, uint256());
+            pcursor->Seek(start);
+            while (pcursor->Valid()) {
+                decltype(start)
+                k;
+                if (!pcursor->GetKey(k) || std::get<0>(k) != prefix) {
+                    break;
+                }
+                vRet.emplace_back(SipHashUint256(filterK0, filterK1, std::get<1>(k)));
+                pcursor->Next();
+            }
+        };
+        scanHashes("rs_s", vSessions);
+        scanHashes("rs_h", vHashes);
+        pcursor.reset();
+
+        auto fillFilter = [](CRecoveredSigsFilter &filter, const std::vector <uint64_t> &vElements) {
+            // leave room for new entries so that the filter does not degrade right away
+            filter.Reset(std::max(MIN_FILTER_CAPACITY, vElements.size() * 2));
+            for (const auto &h: vElements) {
+                filter.Insert(h);
+            }
+        };
+        fillFilter(sigForIdFilter, vIds);
+        fillFilter(sigForSessionFilter, vSessions);
+        fillFilter(sigForHashFilter, vHashes);
+        nFilterStale = 0;
+        nFilterRebuilds++;
+
+        LogPrint(BCLog::LLMQ, "CRecoveredSigsDb::%s -- rebuilt filters with %d ids, %d sessions and %d hashes in %dms\n",
+                 __func__, vIds.size(), vSessions.size(), vHashes.size(), timer.count());
+    }
+
+    bool CRecoveredSigsDb::NeedFilterRebuild() const {
+        AssertLockHeld(cs);
+
+        for (const auto *filter: {&sigForIdFilter, &sigForSessionFilter, &sigForHashFilter}) {
+            if (filter->size() > filter->capacity()) {
+                return true;
+            }
+        }
+        // removed entries stay in the filters and only increase the false positive rate
+        return nFilterStale > sigForIdFilter.capacity() / 4;
+    }
+
+    CRecoveredSigsCacheStats CRecoveredSigsDb::GetCacheStats() const {
+        CRecoveredSigsCacheStats stats;
+        stats.nCacheHits = nCacheHits;
+        stats.nFilterNegatives = nFilterNegatives;
+        stats.nDbReads = nDbReads;
+        stats.nFalsePositives = nFalsePositives;
+        stats.nFilterRebuilds = nFilterRebuilds;
+
+        LOCK(cs);
+        stats.nFilterElements = sigForIdFilter.size() + sigForSessionFilter.size() + sigForHashFilter.size();
+        stats.nFilterCapacity = sigForIdFilter.capacity() + sigForSessionFilter.capacity() + sigForHashFilter.capacity();
+        stats.nCacheEntries = hasSigForIdCache.size() + hasSigForSessionCache.size() + hasSigForHashCache.size();
+        stats.nCacheMaxEntries = hasSigForIdCache.max_size() + hasSigForSessionCache.max_size() + hasSigForHashCache.max_size();
+        stats.nMemoryUsage = hasSigForIdCache.DynamicMemoryUsage() + hasSigForSessionCache.DynamicMemoryUsage() +
+                             hasSigForHashCache.DynamicMemoryUsage() + sigForIdFilter.DynamicMemoryUsage() +
+                             sigForSessionFilter.DynamicMemoryUsage() + sigForHashFilter.DynamicMemoryUsage();
+        return stats;
+    }
+
     void CRecoveredSigsDb::MigrateRecoveredSigs() {
         if (!db->IsEmpty()) return;
 
@@ -240,13 +405,21 @@ namespace llmq {
         {
             LOCK(cs);
             if (hasSigForIdCache.get(cacheKey, ret)) {
+                nCacheHits++;
                 return ret;
             }
+            if (!sigForIdFilter.MaybeContains(SipHashUint256Extra(filterK0, filterK1, id, (uint32_t) llmqType))) {
+                nFilterNegatives++;
+                return false;
+            }
         }
 
-
         auto k = std::make_tuple(std::string("rs_r"), llmqType, id);
         ret = db->Exists(k);
+        nDbReads++;
+        if (!ret) {
+            nFalsePositives++;
+        }
 
         LOCK(cs);
         hasSigForIdCache.insert(cacheKey, ret);
@@ -258,12 +431,21 @@ namespace llmq {
         {
             LOCK(cs);
             if (hasSigForSessionCache.get(signHash, ret)) {
+                nCacheHits++;
                 return ret;
             }
+            if (!sigForSessionFilter.MaybeContains(SipHashUint256(filterK0, filterK1, signHash))) {
+                nFilterNegatives++;
+                return false;
+            }
         }
 
         auto k = std::make_tuple(std::string("rs_s"), signHash);
         ret = db->Exists(k);
+        nDbReads++;
+        if (!ret) {
+            nFalsePositives++;
+        }
 
         LOCK(cs);
         hasSigForSessionCache.insert(signHash, ret);
@@ -275,12 +457,21 @@ namespace llmq {
         {
             LOCK(cs);
             if (hasSigForHashCache.get(hash, ret)) {
+                nCacheHits++;
                 return ret;
             }
+            if (!sigForHashFilter.MaybeContains(SipHashUint256(filterK0, filterK1, hash))) {
+                nFilterNegatives++;
+                return false;
+            }
         }
 
         auto k = std::make_tuple(std::string("rs_h"), hash);
         ret = db->Exists(k);
+        nDbReads++;
+        if (!ret) {
+            nFalsePositives++;
+        }
 
         LOCK(cs);
         hasSigForHashCache.insert(hash, ret);
@@ -352,6 +543,9 @@ namespace llmq {
             hasSigForIdCache.insert(std::make_pair(recSig.getLlmqType(), recSig.getId()), true);
             hasSigForSessionCache.insert(signHash, true);
             hasSigForHashCache.insert(recSig.GetHash(), true);
+            sigForIdFilter.Insert(SipHashUint256Extra(filterK0, filterK1, recSig.getId(), (uint32_t) recSig.getLlmqType()));
+            sigForSessionFilter.Insert(SipHashUint256(filterK0, filterK1, signHash));
+            sigForHashFilter.Insert(SipHashUint256(filterK0, filterK1, recSig.GetHash()));
         }
     }
 
@@ -394,6 +588,7 @@ namespace llmq {
         if (deleteHashKey) {
             hasSigForHashCache.erase(recSig.GetHash());
         }
+        nFilterStale++;
     }
 
 // Completely remove any traces of the recovered sig
@@ -442,6 +637,10 @@ namespace llmq {
         pcursor.reset();
 
         if (toDelete.empty()) {
+            LOCK(cs);
+            if (NeedFilterRebuild()) {
+                RebuildFilters();
+            }
             return;
         }
 
@@ -465,6 +664,11 @@ namespace llmq {
         db->WriteBatch(batch);
 
         LogPrint(BCLog::LLMQ, "CRecoveredSigsDb::%d -- deleted %d entries\n", __func__, toDelete.size());
+
+        LOCK(cs);
+        if (NeedFilterRebuild()) {
+            RebuildFilters();
+        }
     }
 
     bool CRecoveredSigsDb::HasVotedOnId(Consensus::LLMQType llmqType, const uint256 &id) const {
@@ -992,6 +1196,10 @@ namespace llmq {
         return db.GetVoteForId(llmqType, id, msgHashRet);
     }
 
+    CRecoveredSigsCacheStats CSigningManager::GetRecoveredSigsCacheStats() const {
+        return db.GetCacheStats();
+    }
+
     CQuorumCPtr
     CSigningManager::SelectQuorumForSigning(Consensus::LLMQType llmqType, const uint256 &selectionHash, int signHeight,
                                             int signOffset) {
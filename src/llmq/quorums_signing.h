@@ -18,6 +18,7 @@
 
 #include <evo/evodb.h>
 
+#include <atomic>
 #include <unordered_map>
 
 using NodeId = int64_t;
@@ -36,6 +37,8 @@ namespace llmq {
 
 // Keep recovered signatures for a week. This is a "-maxrecsigsage" option default.
     static const int64_t DEFAULT_MAX_RECOVERED_SIGS_AGE = 60 * 60 * 24 * 7;
+// Memory budget (in MiB) for the HasRecoveredSig* lookup caches. This is a "-recsigcache" option default.
+    static const int64_t DEFAULT_RECOVERED_SIGS_CACHE_SIZE = 16;
 
 
     class CSigBase {
@@ -119,24 +122,86 @@ namespace llmq {
         UniValue ToJson() const;
     };
 
+    /**
+     * Insert-only bloom filter used by CRecoveredSigsDb to answer negative lookups without touching the db.
+     * Entries are never removed, so the filter can only err on the side of "maybe present". Stale entries
+     * are dropped by rebuilding the filter from the db.
+     */
+    class CRecoveredSigsFilter {
+    private:
+        // ~10 bits per element and 7 hash functions give a false positive rate below 1%
+        static const size_t BITS_PER_ELEMENT = 10;
+        static const uint32_t HASH_FUNCS = 7;
+
+        std::vector <uint64_t> vBits;
+        uint64_t nBits{0};
+        size_t nCapacity{0};
+        size_t nElements{0};
+
+    public:
+        explicit CRecoveredSigsFilter(size_t _nCapacity = 0) { Reset(_nCapacity); }
+
+        void Reset(size_t _nCapacity);
+
+        void Insert(uint64_t hash);
+
+        bool MaybeContains(uint64_t hash) const;
+
+        size_t size() const { return nElements; }
+
+        size_t capacity() const { return nCapacity; }
+
+        size_t DynamicMemoryUsage() const;
+    };
+
+    struct CRecoveredSigsCacheStats {
+        uint64_t nCacheHits{0};
+        uint64_t nFilterNegatives{0};
+        uint64_t nDbReads{0};
+        uint64_t nFalsePositives{0};
+        uint64_t nFilterRebuilds{0};
+        size_t nFilterElements{0};
+        size_t nFilterCapacity{0};
+        size_t nCacheEntries{0};
+        size_t nCacheMaxEntries{0};
+        size_t nMemoryUsage{0};
+
+        UniValue ToJson() const;
+    };
+
     class CRecoveredSigsDb {
     private:
+        // don't bother rebuilding the filter for less than this many elements
+        static constexpr size_t MIN_FILTER_CAPACITY = 100000;
+
         std::unique_ptr <CDBWrapper> db{nullptr};
 
         mutable RecursiveMutex cs;
-        mutable unordered_lru_cache<std::pair<Consensus::LLMQType, uint256>, bool, StaticSaltedHasher, 30000> hasSigForIdCache
+        mutable unordered_lru_cache<std::pair<Consensus::LLMQType, uint256>, bool, StaticSaltedHasher> hasSigForIdCache
         GUARDED_BY(cs);
-        mutable unordered_lru_cache<uint256, bool, StaticSaltedHasher, 30000> hasSigForSessionCache
+        mutable unordered_lru_cache<uint256, bool, StaticSaltedHasher> hasSigForSessionCache
         GUARDED_BY(cs);
-        mutable unordered_lru_cache<uint256, bool, StaticSaltedHasher, 30000> hasSigForHashCache
+        mutable unordered_lru_cache<uint256, bool, StaticSaltedHasher> hasSigForHashCache
         GUARDED_BY(cs);
 
+        // negative lookup pre-checks, rebuilt from the db once too many stale entries accumulated
+        const uint64_t filterK0{GetRand(std::numeric_limits<uint64_t>::max())};
+        const uint64_t filterK1{GetRand(std::numeric_limits<uint64_t>::max())};
+        CRecoveredSigsFilter sigForIdFilter GUARDED_BY(cs);
+        CRecoveredSigsFilter sigForSessionFilter GUARDED_BY(cs);
+        CRecoveredSigsFilter sigForHashFilter GUARDED_BY(cs);
+        size_t nFilterStale GUARDED_BY(cs){0};
+
+        mutable std::atomic <uint64_t> nCacheHits{0};
+        mutable std::atomic <uint64_t> nFilterNegatives{0};
+        mutable std::atomic <uint64_t> nDbReads{0};
+        mutable std::atomic <uint64_t> nFalsePositives{0};
+        std::atomic <uint64_t> nFilterRebuilds{0};
+
     public:
-        explicit CRecoveredSigsDb(bool fMemory, bool fWipe) :
-                db(std::make_unique<CDBWrapper>(fMemory ? "" : (GetDataDir() / "llmq/recsigdb"), 8 << 20, fMemory,
-                                                fWipe)) {
-            MigrateRecoveredSigs();
-        }
+        explicit CRecoveredSigsDb(bool fMemory, bool fWipe);
+
+        CRecoveredSigsCacheStats GetCacheStats() const;
 
         bool HasRecoveredSig(Consensus::LLMQType llmqType, const uint256 &id, const uint256 &msgHash) const;
 
@@ -170,6 +235,12 @@ namespace llmq {
     private:
         void MigrateRecoveredSigs();
 
+        static size_t GetCacheEntriesLimit();
+
+        void RebuildFilters() EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+        bool NeedFilterRebuild() const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
         bool ReadRecoveredSig(Consensus::LLMQType llmqType, const uint256 &id, CRecoveredSig &ret) const;
 
         void RemoveRecoveredSig(CDBBatch &batch, Consensus::LLMQType llmqType, const uint256 &id, bool deleteHashKey,
@@ -272,6 +343,8 @@ namespace llmq {
 
         bool GetVoteForId(Consensus::LLMQType llmqType, const uint256 &id, uint256 &msgHashRet) const;
 
+        CRecoveredSigsCacheStats GetRecoveredSigsCacheStats() const;
+
         static std::vector <CQuorumCPtr> GetActiveQuorumSet(Consensus::LLMQType llmqType, int signHeight);
 
         static CQuorumCPtr SelectQuorumForSigning(Consensus::LLMQType llmqType, const uint256 &selectionHash,
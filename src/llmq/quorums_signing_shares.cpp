@@ -16,6 +16,7 @@
 #include <smartnode/activesmartnode.h>
 #include <net_processing.h>
 #include <netmessagemaker.h>
+#include <metrics.h>
 #include <spork.h>
 
 #include <cxxtimer.hpp>
@@ -47,6 +48,11 @@ namespace llmq {
         return (size_t) std::count(inv.begin(), inv.end(), true);
     }
 
+    size_t CSigSharesInv::DynamicMemoryUsage() const {
+        // std::vector<bool> is a bitset
+        return memusage::MallocUsage((inv.capacity() + 7) / 8);
+    }
+
     std::string CSigSharesInv::ToString() const {
         std::string str = "(";
         bool first = true;
@@ -108,21 +114,57 @@ namespace llmq {
         s.knows.Init((size_t) llmq_params.size);
     }
 
-    CSigSharesNodeState::Session &CSigSharesNodeState::GetOrCreateSessionFromShare(const llmq::CSigShare &sigShare) {
-        auto &s = sessions[sigShare.GetSignHash()];
-        if (s.announced.inv.empty()) {
-            InitSession(s, sigShare.GetSignHash(), sigShare);
+    size_t CSigSharesNodeState::Session::DynamicMemoryUsage() const {
+        return announced.DynamicMemoryUsage() + requested.DynamicMemoryUsage() + knows.DynamicMemoryUsage();
+    }
+
+    CSigSharesNodeState::Session &CSigSharesNodeState::GetOrCreateSession(const uint256 &signHash, const CSigBase &from) {
+        if (auto it = sessions.find(signHash); it != sessions.end()) {
+            if (it->second.announced.inv.empty()) {
+                nSessionsMemoryUsage -= it->second.DynamicMemoryUsage();
+                InitSession(it->second, signHash, from);
+                nSessionsMemoryUsage += it->second.DynamicMemoryUsage();
+            }
+            return it->second;
         }
+
+        // Drop the oldest sessions of this node first, a single node should not be able to make us track an
+        // unlimited number of sessions
+        while (sessions.size() >= MAX_SESSIONS_PER_NODE && !sessionsOrder.empty()) {
+            const auto[nOrder, oldestSignHash] = sessionsOrder.front();
+            sessionsOrder.pop_front();
+            if (const auto it = sessions.find(oldestSignHash); it != sessions.end() && it->second.nOrder == nOrder) {
+                LogPrint(BCLog::LLMQ_SIGS, "CSigSharesNodeState::%s -- too many sessions, dropping signHash=%s\n",
+                         __func__, oldestSignHash.ToString());
+                RemoveSession(oldestSignHash);
+            }
+        }
+
+        // Get rid of entries for sessions which were removed in the meantime
+        if (sessionsOrder.size() > sessions.size() * 2 + 64) {
+            std::deque <std::pair<uint64_t, uint256>> newOrder;
+            for (const auto &e: sessionsOrder) {
+                if (const auto it = sessions.find(e.second); it != sessions.end() && it->second.nOrder == e.first) {
+                    newOrder.emplace_back(e);
+                }
+            }
+            sessionsOrder = std::move(newOrder);
+        }
+
+        auto &s = sessions[signHash];
+        s.nOrder = nextSessionOrder++;
+        sessionsOrder.emplace_back(s.nOrder, signHash);
+        InitSession(s, signHash, from);
+        nSessionsMemoryUsage += s.DynamicMemoryUsage();
         return s;
     }
 
+    CSigSharesNodeState::Session &CSigSharesNodeState::GetOrCreateSessionFromShare(const llmq::CSigShare &sigShare) {
+        return GetOrCreateSession(sigShare.GetSignHash(), sigShare);
+    }
+
     CSigSharesNodeState::Session &CSigSharesNodeState::GetOrCreateSessionFromAnn(const llmq::CSigSesAnn &ann) {
-        auto signHash = ann.buildSignHash();
-        auto &s = sessions[signHash];
-        if (s.announced.inv.empty()) {
-            InitSession(s, signHash, ann);
-        }
-        return s;
+        return GetOrCreateSession(ann.buildSignHash(), ann);
     }
 
     CSigSharesNodeState::Session *CSigSharesNodeState::GetSessionBySignHash(const uint256 &signHash) {
@@ -159,14 +201,72 @@ namespace llmq {
     void CSigSharesNodeState::RemoveSession(const uint256 &signHash) {
         if (const auto it = sessions.find(signHash); it != sessions.end()) {
             sessionByRecvId.erase(it->second.recvSessionId);
+            nSessionsMemoryUsage -= it->second.DynamicMemoryUsage();
             sessions.erase(it);
         }
         requestedSigShares.EraseAllForSignHash(signHash);
         pendingIncomingSigShares.EraseAllForSignHash(signHash);
     }
 
+    size_t CSigSharesNodeState::GetSessionMemoryUsage(const uint256 &signHash) const {
+        size_t usage = requestedSigShares.DynamicMemoryUsageForSignHash(signHash) +
+                       pendingIncomingSigShares.DynamicMemoryUsageForSignHash(signHash);
+        if (const auto it = sessions.find(signHash); it != sessions.end()) {
+            usage += memusage::MallocUsage(sizeof(memusage::unordered_node<decltype(sessions)::value_type>)) +
+                     it->second.DynamicMemoryUsage();
+        }
+        return usage;
+    }
+
+    size_t CSigSharesNodeState::DynamicMemoryUsage() const {
+        return memusage::DynamicUsage(sessions) + memusage::DynamicUsage(sessionByRecvId) +
+               memusage::MallocUsage(sessionsOrder.size() * sizeof(decltype(sessionsOrder)::value_type)) +
+               nSessionsMemoryUsage + requestedSigShares.DynamicMemoryUsage() +
+               pendingIncomingSigShares.DynamicMemoryUsage();
+    }
+
+    UniValue CSigSharesStats::ToJson(int detailLevel) const {
+        UniValue ret(UniValue::VOBJ);
+        ret.pushKV("sessions", (uint64_t) nSessions);
+        ret.pushKV("sigShares", (uint64_t) nSigShares);
+        ret.pushKV("memoryUsage", (uint64_t) nMemoryUsage);
+        ret.pushKV("maxMemoryUsage", (uint64_t) nMaxMemoryUsage);
+        ret.pushKV("timedOutSessions", nTimedOutSessions);
+        ret.pushKV("shedSessions", nShedSessions);
+
+        UniValue nodesArr(UniValue::VARR);
+        for (const auto &n: nodes) {
+            UniValue obj(UniValue::VOBJ);
+            obj.pushKV("nodeId", n.nodeId);
+            obj.pushKV("sessions", (uint64_t) n.nSessions);
+            obj.pushKV("memoryUsage", (uint64_t) n.nMemoryUsage);
+            nodesArr.push_back(obj);
+        }
+        ret.pushKV("nodes", nodesArr);
+
+        if (detailLevel > 0) {
+            UniValue sessionsArr(UniValue::VARR);
+            for (const auto &session: sessions) {
+                UniValue obj(UniValue::VOBJ);
+                obj.pushKV("signHash", session.signHash.ToString());
+                obj.pushKV("sigShares", (uint64_t) session.nSigShares);
+                obj.pushKV("lastSeenAge", session.nLastSeenAge);
+                obj.pushKV("memoryUsage", (uint64_t) session.nMemoryUsage);
+                sessionsArr.push_back(obj);
+            }
+            ret.pushKV("sessionsDetail", sessionsArr);
+        }
+        return ret;
+    }
+
 //////////////////////
 
+    CSigSharesManager::CSigSharesManager(CConnman &_connman) :
+            connman(_connman),
+            nMaxMemoryUsage(std::max<int64_t>(1, gArgs.GetArg("-maxsigsharesmem", DEFAULT_MAX_SIGSHARES_MEMORY)) << 20) {
+        workInterrupt.reset();
+    }
+
     void CSigSharesManager::StartWorkerThread() {
         // can't start new thread if we have one running already
         if (workThread.joinable()) {
@@ -312,7 +412,15 @@ namespace llmq {
         }
 
         LOCK(cs);
-        auto &nodeState = nodeStates[pfrom->GetId()];
+        ProcessSigSesAnn(pfrom->GetId(), ann, quorum);
+
+        return true;
+    }
+
+    void CSigSharesManager::ProcessSigSesAnn(NodeId fromId, const CSigSesAnn &ann, const CQuorumCPtr &quorum) {
+        AssertLockHeld(cs);
+
+        auto &nodeState = nodeStates[fromId];
         auto &session = nodeState.GetOrCreateSessionFromAnn(ann);
         nodeState.sessionByRecvId.erase(session.recvSessionId);
         nodeState.sessionByRecvId.erase(ann.getSessionId());
@@ -320,7 +428,11 @@ namespace llmq {
         session.quorum = quorum;
         nodeState.sessionByRecvId.try_emplace(ann.getSessionId(), &session);
 
-        return true;
+        // Sessions nobody sent shares for yet must time out and be shed as well. Announcements don't extend their
+        // lifetime though, otherwise peers could keep them around by announcing them over and over
+        if (!timeSeenForSessions.count(session.signHash)) {
+            UpdateTimeSeenForSession(session.signHash, GetAdjustedTime());
+        }
     }
 
     bool CSigSharesManager::VerifySigSharesInv(Consensus::LLMQType llmqType, const CSigSharesInv &inv) {
@@ -655,6 +767,12 @@ namespace llmq {
         cxxtimer::Timer verifyTimer(true);
         batchVerifier.Verify();
         verifyTimer.stop();
+        static auto &histVerify = metrics::GetRegistry().GetHistogram("llmq_sigshares_batch_verify_ms",
+                                                                      "Time to verify a batch of sig shares");
+        static auto &counterVerified = metrics::GetRegistry().GetCounter("llmq_sigshares_verified",
+                                                                         "Number of sig shares verified");
+        histVerify.Observe(verifyTimer.count<std::chrono::microseconds>() * 0.001);
+        counterVerified.Inc(verifyCount);
 
         LogPrint(BCLog::LLMQ_SIGS, "CSigSharesManager::%s -- verified sig shares. count=%d, pt=%d, vt=%d, nodes=%d\n",
                  __func__, verifyCount, prepareTimer.count(), verifyTimer.count(), sigSharesByNodes.size());
@@ -720,7 +838,7 @@ namespace llmq {
             }
 
             // Update the time we've seen the last sigShare
-            timeSeenForSessions[sigShare.GetSignHash()] = GetAdjustedTime();
+            UpdateTimeSeenForSession(sigShare.GetSignHash(), GetAdjustedTime());
 
             if (!quorumNodes.empty()) {
                 // don't announce and wait for other nodes to request this share and directly send it to them
@@ -780,7 +898,11 @@ namespace llmq {
         // now recover it
         cxxtimer::Timer t(true);
         CBLSSignature recoveredSig;
-        if (!recoveredSig.Recover(sigSharesForRecovery, idsForRecovery)) {
+        const bool fRecovered = recoveredSig.Recover(sigSharesForRecovery, idsForRecovery);
+        static auto &histRecover = metrics::GetRegistry().GetHistogram("llmq_sigshares_recover_ms",
+                                                                       "Time to recover a signature from sig shares");
+        histRecover.Observe(t.count<std::chrono::microseconds>() * 0.001);
+        if (!fRecovered) {
             LogPrint(BCLog::LLMQ_SIGS,
                      "CSigSharesManager::%s -- failed to recover signature. id=%s, msgHash=%s, time=%d\n", __func__,
                      id.ToString(), msgHash.ToString(), t.count());
@@ -1268,7 +1390,8 @@ namespace llmq {
 
         {
             LOCK(cs);
-            sigShares.ForEach([&quorums](const SigShareKey &, const CSigShare &sigShare) {
+            sigShares.ForEachSignHash([&quorums](const uint256 &, const std::unordered_map <uint16_t, CSigShare> &m) {
+                const auto &sigShare = m.begin()->second;
                 quorums.try_emplace(std::make_pair(sigShare.getLlmqType(), sigShare.getQuorumHash()), nullptr);
             });
         }
@@ -1287,9 +1410,11 @@ namespace llmq {
             // Now delete sessions which are for inactive quorums
             LOCK(cs);
             std::unordered_set <uint256, StaticSaltedHasher> inactiveQuorumSessions;
-            sigShares.ForEach([&quorums, &inactiveQuorumSessions](const SigShareKey &, const CSigShare &sigShare) {
+            sigShares.ForEachSignHash([&quorums, &inactiveQuorumSessions](const uint256 &signHash,
+                                                                          const std::unordered_map <uint16_t, CSigShare> &m) {
+                const auto &sigShare = m.begin()->second;
                 if (!quorums.count(std::make_pair(sigShare.getLlmqType(), sigShare.getQuorumHash()))) {
-                    inactiveQuorumSessions.emplace(sigShare.GetSignHash());
+                    inactiveQuorumSessions.emplace(signHash);
                 }
             });
             for (auto &signHash: inactiveQuorumSessions) {
@@ -1302,23 +1427,26 @@ namespace llmq {
 
             // Remove sessions which were succesfully recovered
             std::unordered_set <uint256, StaticSaltedHasher> doneSessions;
-            sigShares.ForEach([&doneSessions](const SigShareKey &, const CSigShare &sigShare) {
-                if (doneSessions.count(sigShare.GetSignHash())) {
-                    return;
-                }
-                if (quorumSigningManager->HasRecoveredSigForSession(sigShare.GetSignHash())) {
-                    doneSessions.emplace(sigShare.GetSignHash());
+            sigShares.ForEachSignHash([&doneSessions](const uint256 &signHash, const std::unordered_map <uint16_t, CSigShare> &) {
+                if (quorumSigningManager->HasRecoveredSigForSession(signHash)) {
+                    doneSessions.emplace(signHash);
                 }
             });
             for (auto &signHash: doneSessions) {
                 RemoveSigSharesForSession(signHash);
             }
 
-            // Remove sessions which timed out
+            // Remove sessions which timed out. Only buckets which are old enough need to be looked at
             std::unordered_set <uint256, StaticSaltedHasher> timeoutSessions;
-            for (const auto &[signHash, lastSeenTime]: timeSeenForSessions) {
-                if (now - lastSeenTime >= SESSION_NEW_SHARES_TIMEOUT) {
-                    timeoutSessions.emplace(signHash);
+            for (auto it = sessionsByTimeSeen.begin();
+                 it != sessionsByTimeSeen.end() && now - it->first >= SESSION_NEW_SHARES_TIMEOUT;
+                 it = sessionsByTimeSeen.erase(it)) {
+                nSessionsByTimeSeenSize -= it->second.size();
+                for (const auto &signHash: it->second) {
+                    if (const auto jt = timeSeenForSessions.find(signHash);
+                            jt != timeSeenForSessions.end() && jt->second == it->first) {
+                        timeoutSessions.emplace(signHash);
+                    }
                 }
             }
             for (auto &signHash: timeoutSessions) {
@@ -1356,6 +1484,9 @@ namespace llmq {
                 }
                 RemoveSigSharesForSession(signHash);
             }
+            nTimedOutSessions += timeoutSessions.size();
+
+            ShedOldestSessions(now);
         }
 
         // Find node states for peers that disappeared from CConnman
@@ -1401,6 +1532,111 @@ namespace llmq {
         timeSeenForSessions.erase(signHash);
     }
 
+    void CSigSharesManager::UpdateTimeSeenForSession(const uint256 &signHash, int64_t nTime) {
+        AssertLockHeld(cs);
+
+        auto &timeSeen = timeSeenForSessions[signHash];
+        if (timeSeen != nTime) {
+            timeSeen = nTime;
+            sessionsByTimeSeen[nTime].emplace_back(signHash);
+            nSessionsByTimeSeenSize++;
+        }
+    }
+
+    size_t CSigSharesManager::GetSessionMemoryUsage(const uint256 &signHash) const {
+        AssertLockHeld(cs);
+
+        size_t usage = sigShares.DynamicMemoryUsageForSignHash(signHash) +
+                       sigSharesRequested.DynamicMemoryUsageForSignHash(signHash) +
+                       sigSharesQueuedToAnnounce.DynamicMemoryUsageForSignHash(signHash);
+        for (const auto &[_, nodeState]: nodeStates) {
+            usage += nodeState.GetSessionMemoryUsage(signHash);
+        }
+        return usage;
+    }
+
+    size_t CSigSharesManager::GetMemoryUsage() const {
+        AssertLockHeld(cs);
+
+        size_t usage = sigShares.DynamicMemoryUsage() + sigSharesRequested.DynamicMemoryUsage() +
+                       sigSharesQueuedToAnnounce.DynamicMemoryUsage() + memusage::DynamicUsage(signedSessions) +
+                       memusage::DynamicUsage(timeSeenForSessions) + memusage::DynamicUsage(nodeStates);
+        for (const auto &[_, nodeState]: nodeStates) {
+            usage += nodeState.DynamicMemoryUsage();
+        }
+        // The buckets are accounted without their spare capacity
+        usage += sessionsByTimeSeen.size() *
+                 memusage::MallocUsage(sizeof(memusage::stl_tree_node<decltype(sessionsByTimeSeen)::value_type>)) +
+                 nSessionsByTimeSeenSize * sizeof(uint256);
+        return usage;
+    }
+
+    void CSigSharesManager::ShedOldestSessions(int64_t now) {
+        AssertLockHeld(cs);
+
+        size_t usage = GetMemoryUsage();
+        if (usage <= nMaxMemoryUsage) {
+            return;
+        }
+
+        // Remove whole buckets of the oldest sessions until we're below the limit. Partially processing a bucket
+        // would require to keep it around, so we don't bother
+        size_t nShed{0};
+        for (auto it = sessionsByTimeSeen.begin();
+             it != sessionsByTimeSeen.end() && usage > nMaxMemoryUsage;
+             it = sessionsByTimeSeen.erase(it)) {
+            nSessionsByTimeSeenSize -= it->second.size();
+            for (const auto &signHash: it->second) {
+                if (const auto jt = timeSeenForSessions.find(signHash);
+                        jt == timeSeenForSessions.end() || jt->second != it->first) {
+                    continue;
+                }
+                RemoveSigSharesForSession(signHash);
+                nShed++;
+            }
+            usage = GetMemoryUsage();
+        }
+        nShedSessions += nShed;
+
+        LogPrint(BCLog::LLMQ_SIGS, "CSigSharesManager::%s -- shed %d sessions, memoryUsage=%d, maxMemoryUsage=%d\n",
+                 __func__, nShed, usage, nMaxMemoryUsage);
+    }
+
+    CSigSharesStats CSigSharesManager::GetStats(bool fSessions) {
+        CSigSharesStats stats;
+        int64_t now = GetAdjustedTime();
+
+        LOCK(cs);
+        stats.nSessions = sigShares.SignHashCount();
+        stats.nSigShares = sigShares.Size();
+        stats.nMemoryUsage = GetMemoryUsage();
+        stats.nMaxMemoryUsage = nMaxMemoryUsage;
+        stats.nTimedOutSessions = nTimedOutSessions;
+        stats.nShedSessions = nShedSessions;
+
+        for (const auto &[nodeId, nodeState]: nodeStates) {
+            CSigSharesStats::NodeStats nodeStats;
+            nodeStats.nodeId = nodeId;
+            nodeStats.nSessions = nodeState.sessions.size();
+            nodeStats.nMemoryUsage = nodeState.DynamicMemoryUsage();
+            stats.nodes.emplace_back(nodeStats);
+        }
+
+        if (fSessions) {
+            sigShares.ForEachSignHash([&](const uint256 &signHash, const std::unordered_map <uint16_t, CSigShare> &m) {
+                CSigSharesStats::SessionStats sessionStats;
+                sessionStats.signHash = signHash;
+                sessionStats.nSigShares = m.size();
+                if (const auto it = timeSeenForSessions.find(signHash); it != timeSeenForSessions.end()) {
+                    sessionStats.nLastSeenAge = now - it->second;
+                }
+                sessionStats.nMemoryUsage = GetSessionMemoryUsage(signHash);
+                stats.sessions.emplace_back(sessionStats);
+            });
+        }
+        return stats;
+    }
+
     void CSigSharesManager::RemoveBannedNodeStates() {
         // Called regularly to cleanup local node states for banned nodes
 
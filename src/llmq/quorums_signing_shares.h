@@ -8,6 +8,7 @@
 
 #include <bls/bls.h>
 #include <llmq/quorums_signing.h>
+#include <memusage.h>
 #include <net.h>
 #include <random.h>
 #include <saltedhasher.h>
@@ -15,6 +16,8 @@
 #include <sync.h>
 #include <uint256.h>
 
+#include <deque>
+#include <map>
 #include <optional>
 #include <thread>
 #include <unordered_map>
@@ -29,6 +32,9 @@ class CDeterministicMN;
 using CDeterministicMNCPtr = std::shared_ptr<const CDeterministicMN>;
 
 namespace llmq {
+// Keep signing session state below this many megabytes. This is a "-maxsigsharesmem" option default.
+    static const int64_t DEFAULT_MAX_SIGSHARES_MEMORY = 64;
+
 // <signHash, quorumMember>
     using SigShareKey = std::pair<uint256, uint16_t>;
 
@@ -133,6 +139,8 @@ public:
 
     [[nodiscard]] size_t CountSet() const;
 
+    [[nodiscard]] size_t DynamicMemoryUsage() const;
+
     [[nodiscard]] std::string ToString() const;
 };
 
@@ -155,11 +163,16 @@ template<typename T>
 class SigShareMap {
 private:
     std::unordered_map <uint256, std::unordered_map<uint16_t, T>, StaticSaltedHasher> internalMap;
+    size_t nSize{0};
 
 public:
     bool Add(const SigShareKey &k, const T &v) {
         auto &m = internalMap[k.first];
-        return m.emplace(k.second, v).second;
+        if (!m.emplace(k.second, v).second) {
+            return false;
+        }
+        nSize++;
+        return true;
     }
 
     void Erase(const SigShareKey &k) {
@@ -167,7 +180,7 @@ public:
         if (it == internalMap.end()) {
             return;
         }
-        it->second.erase(k.second);
+        nSize -= it->second.erase(k.second);
         if (it->second.empty()) {
             internalMap.erase(it);
         }
@@ -175,6 +188,7 @@ public:
 
     void Clear() {
         internalMap.clear();
+        nSize = 0;
     }
 
     [[nodiscard]] bool Has(const SigShareKey &k) const {
@@ -216,11 +230,11 @@ public:
     }
 
     [[nodiscard]] size_t Size() const {
-        size_t s = 0;
-        for (auto &p: internalMap) {
-            s += p.second.size();
-        }
-        return s;
+        return nSize;
+    }
+
+    [[nodiscard]] size_t SignHashCount() const {
+        return internalMap.size();
     }
 
     [[nodiscard]] size_t CountForSignHash(const uint256 &signHash) const {
@@ -244,7 +258,30 @@ public:
     }
 
     void EraseAllForSignHash(const uint256 &signHash) {
-        internalMap.erase(signHash);
+        auto it = internalMap.find(signHash);
+        if (it == internalMap.end()) {
+            return;
+        }
+        nSize -= it->second.size();
+        internalMap.erase(it);
+    }
+
+    // Only accounts for the map structures, not for memory owned by T
+    [[nodiscard]] size_t DynamicMemoryUsageForSignHash(const uint256 &signHash) const {
+        auto it = internalMap.find(signHash);
+        if (it == internalMap.end()) {
+            return 0;
+        }
+        return memusage::MallocUsage(sizeof(memusage::unordered_node<typename decltype(internalMap)::value_type>)) +
+               memusage::DynamicUsage(it->second);
+    }
+
+    // Derived from the running entry count instead of walking the inner maps, each entry is accounted with its
+    // node and one bucket pointer
+    [[nodiscard]] size_t DynamicMemoryUsage() const {
+        return memusage::DynamicUsage(internalMap) +
+               nSize * (memusage::MallocUsage(sizeof(memusage::unordered_node<std::pair<const uint16_t, T>>)) +
+                        sizeof(void *));
     }
 
     template<typename F>
@@ -256,6 +293,7 @@ public:
                 k.second = jt->first;
                 if (f(k, jt->second)) {
                     jt = it->second.erase(jt);
+                    nSize--;
                 } else {
                     ++jt;
                 }
@@ -279,6 +317,14 @@ public:
             }
         }
     }
+
+    // Calls f once per signHash with all entries for it, which is much cheaper than ForEach for per-session checks
+    template<typename F>
+    void ForEachSignHash(F &&f) const {
+        for (const auto &p: internalMap) {
+            f(p.first, p.second);
+        }
+    }
 };
 
 class CSigSharesNodeState {
@@ -309,9 +355,21 @@ public:
         CSigSharesInv announced;
         CSigSharesInv requested;
         CSigSharesInv knows;
+
+        // creation order, used to drop the oldest sessions first when a node exceeds MAX_SESSIONS_PER_NODE
+        uint64_t nOrder{0};
+
+        [[nodiscard]] size_t DynamicMemoryUsage() const;
     };
-    // TODO limit number of sessions per node
+
+    static constexpr size_t MAX_SESSIONS_PER_NODE{10000};
+
     std::unordered_map <uint256, Session, StaticSaltedHasher> sessions;
+    // <nOrder, signHash> in creation order. May contain entries for sessions which were removed already
+    std::deque <std::pair<uint64_t, uint256>> sessionsOrder;
+    uint64_t nextSessionOrder{0};
+    // memory owned by the sessions, updated when sessions are created or removed
+    size_t nSessionsMemoryUsage{0};
 
     std::unordered_map<uint32_t, Session *> sessionByRecvId;
     uint32_t nextSendSessionId{1};
@@ -332,6 +390,38 @@ public:
     bool GetSessionInfoByRecvId(uint32_t sessionId, SessionInfo &retInfo);
 
     void RemoveSession(const uint256 &signHash);
+
+    [[nodiscard]] size_t GetSessionMemoryUsage(const uint256 &signHash) const;
+
+    [[nodiscard]] size_t DynamicMemoryUsage() const;
+
+private:
+    Session &GetOrCreateSession(const uint256 &signHash, const CSigBase &from);
+};
+
+struct CSigSharesStats {
+    struct SessionStats {
+        uint256 signHash;
+        size_t nSigShares{0};
+        int64_t nLastSeenAge{0};
+        size_t nMemoryUsage{0};
+    };
+    struct NodeStats {
+        NodeId nodeId{-1};
+        size_t nSessions{0};
+        size_t nMemoryUsage{0};
+    };
+
+    size_t nSessions{0};
+    size_t nSigShares{0};
+    size_t nMemoryUsage{0};
+    size_t nMaxMemoryUsage{0};
+    uint64_t nTimedOutSessions{0};
+    uint64_t nShedSessions{0};
+    std::vector <NodeStats> nodes;
+    std::vector <SessionStats> sessions;
+
+    UniValue ToJson(int detailLevel) const;
 };
 
 class CSignedSession {
@@ -381,6 +471,14 @@ private:
     // stores time of last receivedSigShare. Used to detect timeouts
     std::unordered_map <uint256, int64_t, StaticSaltedHasher> timeSeenForSessions
     GUARDED_BY(cs);
+    // sessions bucketed by the time they were last seen at, so that timeouts don't require scanning all sessions.
+    // A session is only expired from the bucket matching its current entry in timeSeenForSessions, older ones are stale
+    std::map <int64_t, std::vector<uint256>> sessionsByTimeSeen
+    GUARDED_BY(cs);
+    // number of entries in all buckets of sessionsByTimeSeen
+    size_t nSessionsByTimeSeenSize GUARDED_BY(cs){0};
+    uint64_t nTimedOutSessions GUARDED_BY(cs){0};
+    uint64_t nShedSessions GUARDED_BY(cs){0};
 
     std::unordered_map <NodeId, CSigSharesNodeState> nodeStates
     GUARDED_BY(cs);
@@ -409,11 +507,10 @@ private:
     CConnman &connman;
     int64_t lastCleanupTime{0};
     std::atomic <uint32_t> recoveredSigsCounter{0};
+    const size_t nMaxMemoryUsage;
 
 public:
-    explicit CSigSharesManager(CConnman &_connman) : connman(_connman) {
-        workInterrupt.reset();
-    };
+    explicit CSigSharesManager(CConnman &_connman);
 
     CSigSharesManager() = delete;
 
@@ -443,10 +540,18 @@ public:
 
     static CDeterministicMNCPtr SelectMemberForRecovery(const CQuorumCPtr &quorum, const uint256 &id, size_t attempt);
 
+    CSigSharesStats GetStats(bool fSessions);
+
 private:
+    friend class CSigSharesManagerTest;
+
     // all of these return false when the currently processed message should be aborted (as each message actually contains multiple messages)
     bool ProcessMessageSigSesAnn(const CNode *pfrom, const CSigSesAnn &ann);
 
+    void ProcessSigSesAnn(NodeId fromId, const CSigSesAnn &ann, const CQuorumCPtr &quorum)
+
+    EXCLUSIVE_LOCKS_REQUIRED(cs);
+
     bool ProcessMessageSigSharesInv(const CNode *pfrom, const CSigSharesInv &inv);
 
     bool ProcessMessageGetSigShares(const CNode *pfrom, const CSigSharesInv &inv);
@@ -486,6 +591,23 @@ private:
 
     EXCLUSIVE_LOCKS_REQUIRED(cs);
 
+    void UpdateTimeSeenForSession(const uint256 &signHash, int64_t nTime)
+
+    EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    size_t GetSessionMemoryUsage(const uint256 &signHash) const
+
+    EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    // Doesn't walk the sessions, the containers keep running counts of their usage
+    size_t GetMemoryUsage() const
+
+    EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    void ShedOldestSessions(int64_t now)
+
+    EXCLUSIVE_LOCKS_REQUIRED(cs);
+
     void RemoveBannedNodeStates();
 
     void BanNode(NodeId nodeId);
@@ -9,6 +9,8 @@
 #include <util/string.h>
 #include <util/time.h>
 
+#include <cstdlib>
+
 const char *const DEFAULT_DEBUGLOGFILE = "debug.log";
 
 BCLog::Logger &LogInstance() {
@@ -37,6 +39,61 @@ static int FileWriteStr(const std::string &str, FILE *fp) {
     return fwrite(str.data(), 1, str.size(), fp);
 }
 
+static size_t RoundUpToPowerOfTwo(size_t n) {
+    size_t nRet = 1;
+    while (nRet < n) nRet <<= 1;
+    return nRet;
+}
+
+BCLog::LogRingBuffer::LogRingBuffer(size_t nCapacity) :
+        m_mask(RoundUpToPowerOfTwo(std::max<size_t>(nCapacity, 2)) - 1),
+        m_slots(new Slot[m_mask + 1]) {
+    for (size_t i = 0; i <= m_mask; i++) {
+        m_slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool BCLog::LogRingBuffer::Push(std::string &&str, size_t nPrefixLen) {
+    size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    while (true) {
+        Slot &slot = m_slots[pos & m_mask];
+        const size_t seq = slot.seq.load(std::memory_order_acquire);
+        const intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+        if (diff == 0) {
+            // The slot is free for this position, claim the position
+            if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.str = std::move(str);
+                slot.nPrefixLen = nPrefixLen;
+                slot.seq.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            // The slot still holds the line of the previous lap
+            return false;
+        } else {
+            // Another thread claimed the position
+            pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool BCLog::LogRingBuffer::Empty() const {
+    return m_slots[m_dequeue_pos & m_mask].seq.load(std::memory_order_acquire) != m_dequeue_pos + 1;
+}
+
+bool BCLog::LogRingBuffer::Pop(std::string &str, size_t *pnPrefixLen) {
+    Slot &slot = m_slots[m_dequeue_pos & m_mask];
+    if (slot.seq.load(std::memory_order_acquire) != m_dequeue_pos + 1) {
+        return false;
+    }
+    str = std::move(slot.str);
+    if (pnPrefixLen) *pnPrefixLen = slot.nPrefixLen;
+    slot.str = std::string();
+    slot.seq.store(m_dequeue_pos + m_mask + 1, std::memory_order_release);
+    m_dequeue_pos++;
+    return true;
+}
+
 bool BCLog::Logger::StartLogging() {
     StdLockGuard scoped_lock(m_cs);
 
@@ -69,10 +126,103 @@ bool BCLog::Logger::StartLogging() {
     }
     if (m_print_to_console) fflush(stdout);
 
+    if (m_async && (m_print_to_file || m_print_to_console)) {
+        m_async_queue = std::make_unique<LogRingBuffer>(LOG_ASYNC_QUEUE_SIZE);
+        m_async_stop = false;
+        m_async_done = false;
+        m_async_thread = std::thread(&BCLog::Logger::AsyncWriterThread, this);
+        m_async_active = true;
+        if (this == &LogInstance()) {
+            // Also write out the queue on exit() paths which skip Shutdown()
+            static std::once_flag registered;
+            std::call_once(registered, [] { std::atexit([] { LogInstance().StopAsyncLogging(); }); });
+        }
+    }
+
     return true;
 }
 
+void BCLog::Logger::AsyncWriterThread() {
+    util::ThreadRename("logger");
+    uint64_t nDroppedReported = 0;
+    std::string batch;
+    std::string str;
+    while (true) {
+        // Logging threads are done pushing once the stop flag is set, so draining the queue after seeing it set
+        // writes out every line
+        const bool fStop = m_async_stop;
+
+        {
+            StdLockGuard scoped_lock(m_cs);
+            batch.clear();
+            size_t nPrefixLen;
+            while (batch.size() < LOG_ASYNC_BATCH_SIZE && m_async_queue->Pop(str, &nPrefixLen)) {
+                // Lines were queued with their full prefix, which only belongs at the start of a line
+                batch.append(str, m_started_new_line ? 0 : nPrefixLen, std::string::npos);
+                m_started_new_line = str.size() > nPrefixLen && str.back() == '\n';
+            }
+            const uint64_t nDropped = m_async_dropped;
+            if (nDropped != nDroppedReported) {
+                batch += LogTimestampStr(strprintf("%u log messages were dropped, the log queue was full\n",
+                                                   nDropped - nDroppedReported), m_started_new_line);
+                m_started_new_line = true;
+                nDroppedReported = nDropped;
+            }
+            if (!batch.empty()) {
+                WriteStr(batch);
+                continue;
+            }
+        }
+        if (fStop) {
+            break;
+        }
+
+        std::unique_lock <std::mutex> lock(m_async_mutex);
+        m_async_waiting = true;
+        // Pairs with the fence in LogPrintStr, either the logging thread sees us waiting or we see its line
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        m_async_cond.wait_for(lock, std::chrono::milliseconds(100), [this] {
+            return m_async_stop || !m_async_queue->Empty();
+        });
+        m_async_waiting = false;
+    }
+    m_async_done = true;
+}
+
+void BCLog::Logger::StopAsyncLogging() {
+    if (!m_async_active.exchange(false)) {
+        return;
+    }
+    // Lines pushed by threads which saw async mode still active must be in the queue before the writer drains it
+    while (m_async_pushing.load() != 0) {
+        std::this_thread::yield();
+    }
+    {
+        std::lock_guard <std::mutex> lock(m_async_mutex);
+        m_async_stop = true;
+    }
+    m_async_cond.notify_one();
+    if (m_async_thread.joinable()) {
+        m_async_thread.join();
+    }
+}
+
+void BCLog::Logger::FlushAsyncLoggingOnCrash() {
+    if (!m_async_active.exchange(false)) {
+        return;
+    }
+    m_async_stop = true;
+    m_async_cond.notify_one();
+    if (std::this_thread::get_id() == m_async_thread.get_id()) {
+        return;
+    }
+    for (int i = 0; i < 100 && !m_async_done; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
 void BCLog::Logger::DisconnectTestLogger() {
+    StopAsyncLogging();
     StdLockGuard scoped_lock(m_cs);
     m_buffering = true;
     if (m_fileout != nullptr) fclose(m_fileout);
@@ -164,7 +314,8 @@ const CLogCategoryDesc LogCategories[] =
                 {BCLog::NETCONN,     "netconn"},
                 {BCLog::QUORUMS,     "quorums"},
                 {BCLog::COIN,         "405Coin"},
-                {BCLog::UPDATES,     "updates"}
+                {BCLog::UPDATES,     "updates"},
+                {BCLog::STRATUM,     "stratum"}
                 //End 405Coin
         };
 
@@ -201,13 +352,13 @@ std::vector <LogCategory> BCLog::Logger::LogCategoriesList() const {
     return ret;
 }
 
-std::string BCLog::Logger::LogTimestampStr(const std::string &str) {
+std::string BCLog::Logger::LogTimestampStr(const std::string &str, bool started_new_line) {
     std::string strStamped;
 
     if (!m_log_timestamps)
         return str;
 
-    if (m_started_new_line) {
+    if (started_new_line) {
         int64_t nTimeMicros = GetTimeMicros();
         strStamped = FormatISO8601DateTime(nTimeMicros / 1000000);
         if (m_log_time_micros) {
@@ -226,24 +377,47 @@ std::string BCLog::Logger::LogTimestampStr(const std::string &str) {
     return strStamped;
 }
 
-void
-BCLog::Logger::LogPrintStr(const std::string &str, const std::string &logging_function, const std::string &source_file,
-                           const int source_line) {
-    StdLockGuard scoped_lock(m_cs);
+std::string BCLog::Logger::PrefixLogStr(const std::string &str, const std::string &logging_function,
+                                        const std::string &source_file, int source_line, bool started_new_line) {
     std::string str_prefixed = str;
 
-    if (m_log_sourcelocations && m_started_new_line) {
+    if (m_log_sourcelocations && started_new_line) {
         str_prefixed.insert(0, "[" + RemovePrefix(source_file, "./") + ":" + ToString(source_line) + "] [" +
                                logging_function + "] ");
     }
 
-    if (m_log_threadnames && m_started_new_line) {
+    if (m_log_threadnames && started_new_line) {
         // 16 chars total, "405-" is 4 of them and another 1 is a NUL terminator
         str_prefixed.insert(0, "[" + strprintf("%11s", util::ThreadGetInternalName()) + "] ");
     }
 
-    str_prefixed = LogTimestampStr(str_prefixed);
+    return LogTimestampStr(str_prefixed, started_new_line);
+}
 
+void
+BCLog::Logger::LogPrintStr(const std::string &str, const std::string &logging_function, const std::string &source_file,
+                           const int source_line) {
+    m_async_pushing++;
+    if (m_async_active) {
+        // Whether the line continues another one is only known once the writer thread pops it
+        std::string str_prefixed = PrefixLogStr(str, logging_function, source_file, source_line, true);
+        const size_t nPrefixLen = str_prefixed.size() - str.size();
+        if (!m_async_queue->Push(std::move(str_prefixed), nPrefixLen)) {
+            m_async_dropped++;
+        }
+        m_async_pushing--;
+        // Pairs with the fence of the writer thread, either it sees the line or we see it waiting
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_async_waiting) {
+            { std::lock_guard <std::mutex> lock(m_async_mutex); }
+            m_async_cond.notify_one();
+        }
+        return;
+    }
+    m_async_pushing--;
+
+    StdLockGuard scoped_lock(m_cs);
+    std::string str_prefixed = PrefixLogStr(str, logging_function, source_file, source_line, m_started_new_line);
     m_started_new_line = !str.empty() && str[str.size() - 1] == '\n';
 
     if (m_buffering) {
@@ -252,6 +426,10 @@ BCLog::Logger::LogPrintStr(const std::string &str, const std::string &logging_fu
         return;
     }
 
+    WriteStr(str_prefixed);
+}
+
+void BCLog::Logger::WriteStr(const std::string &str_prefixed) {
     if (m_print_to_console) {
         // print to console
         fwrite(str_prefixed.data(), 1, str_prefixed.size(), stdout);
@@ -12,10 +12,13 @@
 #include <util/string.h>
 
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 static const bool DEFAULT_LOGTIMEMICROS = false;
@@ -23,6 +26,7 @@ static const bool DEFAULT_LOGIPS = false;
 static const bool DEFAULT_LOGTIMESTAMPS = true;
 static const bool DEFAULT_LOGTHREADNAMES = false;
 static const bool DEFAULT_LOGSOURCELOCATIONS = false;
+static const bool DEFAULT_LOGASYNC = false;
 extern const char *const DEFAULT_DEBUGLOGFILE;
 
 extern bool fLogThreadNames;
@@ -73,9 +77,10 @@ namespace BCLog {
         NETCONN = ((uint64_t) 1 << 43),
         QUORUMS = ((uint64_t) 1 << 44),
         UPDATES = ((uint64_t) 1 << 45),
+        STRATUM = ((uint64_t) 1 << 46),
 
         COIN = CHAINLOCKS | GOBJECT | INSTANTSEND | LLMQ | LLMQ_DKG | LLMQ_SIGS
-              | MNPAYMENTS | MNSYNC | COINJOIN | SPORK | NETCONN | QUORUMS | UPDATES,
+              | MNPAYMENTS | MNSYNC | COINJOIN | SPORK | NETCONN | QUORUMS | UPDATES | STRATUM,
 
         NET_NETCONN = NET | NETCONN, // use this to have something logged in NET and NETCONN as well
         //End 405Coin
@@ -83,6 +88,48 @@ namespace BCLog {
         ALL = ~(uint64_t) 0,
     };
 
+    /**
+     * Bounded queue of log lines, pushed to by any thread and popped by a single one. Based on Dmitry Vyukov's bounded
+     * MPMC queue: each slot carries a sequence number telling whether it's free for the position being pushed or
+     * filled for the position being popped, so neither side takes a lock. Pushing never waits for the consumer, it
+     * fails when the queue is full.
+     */
+    class LogRingBuffer {
+    public:
+        /** nCapacity is rounded up to a power of two */
+        explicit LogRingBuffer(size_t nCapacity);
+
+        /** Returns false, leaving str alone, if the queue is full. The first nPrefixLen characters of str are its
+         *  line prefix. */
+        bool Push(std::string &&str, size_t nPrefixLen = 0);
+
+        /** Only to be called by the consumer thread. Returns false if the queue is empty. */
+        bool Pop(std::string &str, size_t *pnPrefixLen = nullptr);
+
+        /** Only to be called by the consumer thread */
+        bool Empty() const;
+
+        size_t Capacity() const { return m_mask + 1; }
+
+    private:
+        struct Slot {
+            std::atomic<size_t> seq;
+            std::string str;
+            size_t nPrefixLen{0};
+        };
+
+        const size_t m_mask;
+        const std::unique_ptr<Slot[]> m_slots;
+        // Separate cache lines, producers only touch the first and the consumer the second
+        alignas(64) std::atomic<size_t> m_enqueue_pos{0};
+        alignas(64) size_t m_dequeue_pos{0};
+    };
+
+    //! Log lines the async writer queues, lines logged while it's full are dropped
+    static const size_t LOG_ASYNC_QUEUE_SIZE = 1 << 16;
+    //! The async writer gathers queued lines into writes of up to this many bytes
+    static const size_t LOG_ASYNC_BATCH_SIZE = 1 << 16;
+
     class Logger {
     private:
         mutable StdMutex m_cs; // Can not use Mutex from sync.h because in debug mode it would cause deadlock when a potential deadlock was detected
@@ -99,15 +146,43 @@ namespace BCLog {
          * printing of the timestamp when multiple calls are made
          * that do not end in a newline.
          */
-        std::atomic_bool m_started_new_line{true};
+        bool m_started_new_line
+        GUARDED_BY(m_cs) = true;
 
         /** Log categories bitfield. */
         std::atomic <uint64_t> m_categories{0};
 
-        std::string LogTimestampStr(const std::string &str);
+        /**
+         * Async mode: log lines are prefixed by the logging thread and queued in m_async_queue, the writer thread
+         * writes them out in batches so logging threads never wait for the disk or the console. Only the writer
+         * knows the order of the lines, so it tracks m_started_new_line and strips the prefix of continued lines.
+         */
+        std::unique_ptr <LogRingBuffer> m_async_queue;
+        std::thread m_async_thread;
+        //! Whether lines go to m_async_queue, checked by logging threads without m_cs
+        std::atomic<bool> m_async_active{false};
+        //! Logging threads between checking m_async_active and pushing their line
+        std::atomic<int> m_async_pushing{0};
+        std::atomic<bool> m_async_stop{false};
+        //! Set by the writer thread once it wrote out everything and exited
+        std::atomic<bool> m_async_done{false};
+        std::atomic <uint64_t> m_async_dropped{0};
+        StdMutex m_async_mutex;
+        std::condition_variable m_async_cond;
+        std::atomic<bool> m_async_waiting{false};
+
+        std::string LogTimestampStr(const std::string &str, bool started_new_line);
 
         std::string LogThreadNameStr(const std::string &str);
 
+        std::string PrefixLogStr(const std::string &str, const std::string &logging_function,
+                                 const std::string &source_file, int source_line, bool started_new_line);
+
+        /** Writes to the console and the log file */
+        void WriteStr(const std::string &str) EXCLUSIVE_LOCKS_REQUIRED(m_cs);
+
+        void AsyncWriterThread();
+
     public:
         bool m_print_to_console = false;
         bool m_print_to_file = false;
@@ -117,6 +192,9 @@ namespace BCLog {
         bool m_log_threadnames = DEFAULT_LOGTHREADNAMES;
         bool m_log_sourcelocations = DEFAULT_LOGSOURCELOCATIONS;
 
+        //! Write from a background thread, see StartAsyncLogging
+        bool m_async = DEFAULT_LOGASYNC;
+
         fs::path m_file_path;
         std::atomic<bool> m_reopen_file{false};
 
@@ -130,9 +208,24 @@ namespace BCLog {
             return m_buffering || m_print_to_console || m_print_to_file;
         }
 
-        /** Start logging (and flush all buffered messages) */
+        /** Start logging (and flush all buffered messages), in async mode if m_async is set */
         bool StartLogging();
 
+        /**
+         * Stops async mode once every queued line is written, later lines are written by the logging thread again.
+         * Nothing happens if async mode isn't running.
+         */
+        void StopAsyncLogging();
+
+        /**
+         * For crash handlers: switches back to writing from the logging thread and gives the writer thread a moment
+         * to write out what it has queued, without waiting for it to exit as it may be the thread crashing.
+         */
+        void FlushAsyncLoggingOnCrash();
+
+        /** Lines dropped so far because the async queue was full */
+        uint64_t GetAsyncDropped() const { return m_async_dropped.load(); }
+
         /** Only for testing */
         void DisconnectTestLogger();
 
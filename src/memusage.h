@@ -6,6 +6,7 @@
 #define BITCOIN_MEMUSAGE_H
 
 #include <indirectmap.h>
+#include <support/allocators/pool.h>
 
 #include <stdlib.h>
 
@@ -162,6 +163,18 @@ namespace memusage {
                MallocUsage(sizeof(void *) * m.bucket_count());
     }
 
+    template<class Key, class T, class Hash, class Pred, std::size_t MAX_BLOCK_SIZE_BYTES, std::size_t ALIGN_BYTES>
+    static inline size_t DynamicUsage(const std::unordered_map <Key, T, Hash, Pred,
+            PoolAllocator<std::pair<const Key, T>, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>> &m) {
+        // The nodes live in the resource's chunks, so count those (plus their std::list node of 3 pointers)
+        // instead of the nodes. Memory of erased nodes stays in the chunks until the resource is destroyed.
+        // The bucket array is too large for the pool and allocated separately.
+        const auto *pool_resource = m.get_allocator().resource();
+        const size_t nChunks = pool_resource->NumAllocatedChunks();
+        return (MallocUsage(pool_resource->ChunkSizeBytes()) + MallocUsage(sizeof(void *) * 3)) * nChunks +
+               MallocUsage(sizeof(void *) * m.bucket_count());
+    }
+
 }
 
 #endif // BITCOIN_MEMUSAGE_H
@@ -0,0 +1,130 @@
+// Copyright (c) 2025 The 405Coin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <metrics.h>
+
+#include <tinyformat.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace metrics {
+
+    const std::vector<double> DEFAULT_LATENCY_BUCKETS_MS{0.1, 0.25, 0.5, 1, 2.5, 5, 10, 25, 50, 100, 250, 500, 1000,
+                                                         2500, 5000, 10000};
+
+    // Metric names must not start with a digit, so the prefix can't be the name of the coin
+    static const std::string METRICS_PREFIX = "coin405_";
+
+    double Histogram::Snapshot::Quantile(double q) const {
+        if (nCount == 0) {
+            return 0;
+        }
+        const double rank = std::min(std::max(q, 0.0), 1.0) * nCount;
+        uint64_t nBelow = 0;
+        for (size_t i = 0; i < vCounts.size(); i++) {
+            if (vCounts[i] == 0 || nBelow + vCounts[i] < rank) {
+                nBelow += vCounts[i];
+                continue;
+            }
+            if (i == vBounds.size()) {
+                // Nothing is known about the observations above the last bound
+                return vBounds.empty() ? 0 : vBounds.back();
+            }
+            const double lower = i == 0 ? 0 : vBounds[i - 1];
+            return lower + (vBounds[i] - lower) * (rank - nBelow) / vCounts[i];
+        }
+        return vBounds.empty() ? 0 : vBounds.back();
+    }
+
+    Histogram::Histogram(std::vector<double> bounds) :
+            vBounds(std::move(bounds)),
+            counts(new std::atomic<uint64_t>[vBounds.size() + 1]) {
+        assert(std::is_sorted(vBounds.begin(), vBounds.end()));
+        for (size_t i = 0; i <= vBounds.size(); i++) {
+            counts[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void Histogram::Observe(double v) {
+        const size_t i = std::lower_bound(vBounds.begin(), vBounds.end(), v) - vBounds.begin();
+        counts[i].fetch_add(1, std::memory_order_relaxed);
+        double cur = sum.load(std::memory_order_relaxed);
+        while (!sum.compare_exchange_weak(cur, cur + v, std::memory_order_relaxed)) {}
+    }
+
+    Histogram::Snapshot Histogram::GetSnapshot() const {
+        Snapshot snapshot;
+        snapshot.vBounds = vBounds;
+        snapshot.vCounts.resize(vBounds.size() + 1);
+        for (size_t i = 0; i <= vBounds.size(); i++) {
+            snapshot.vCounts[i] = counts[i].load(std::memory_order_relaxed);
+            snapshot.nCount += snapshot.vCounts[i];
+        }
+        snapshot.sum = sum.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    template<typename T, typename... Args>
+    static T &GetOrCreate(std::map<std::string, T> &map, const std::string &name, const std::string &help,
+                          Args &&... args) {
+        auto it = map.find(name);
+        if (it == map.end()) {
+            it = map.emplace(name, T{help, std::make_unique<typename decltype(T::metric)::element_type>(
+                    std::forward<Args>(args)...)}).first;
+        }
+        return it->second;
+    }
+
+    Counter &Registry::GetCounter(const std::string &name, const std::string &help) {
+        LOCK(cs);
+        return *GetOrCreate(mapCounters, name, help).metric;
+    }
+
+    Gauge &Registry::GetGauge(const std::string &name, const std::string &help) {
+        LOCK(cs);
+        return *GetOrCreate(mapGauges, name, help).metric;
+    }
+
+    Histogram &Registry::GetHistogram(const std::string &name, const std::string &help,
+                                      const std::vector<double> &bounds) {
+        LOCK(cs);
+        return *GetOrCreate(mapHistograms, name, help, bounds).metric;
+    }
+
+    std::string Registry::RenderPrometheus() const {
+        LOCK(cs);
+        std::string out;
+        for (const auto &p: mapCounters) {
+            const std::string name = METRICS_PREFIX + p.first;
+            out += strprintf("# HELP %s %s\n# TYPE %s counter\n%s %u\n", name, p.second.help, name, name,
+                             p.second.metric->Get());
+        }
+        for (const auto &p: mapGauges) {
+            const std::string name = METRICS_PREFIX + p.first;
+            out += strprintf("# HELP %s %s\n# TYPE %s gauge\n%s %g\n", name, p.second.help, name, name,
+                             p.second.metric->Get());
+        }
+        for (const auto &p: mapHistograms) {
+            const std::string name = METRICS_PREFIX + p.first;
+            const auto snapshot = p.second.metric->GetSnapshot();
+            out += strprintf("# HELP %s %s\n# TYPE %s histogram\n", name, p.second.help, name);
+            uint64_t nCumulative = 0;
+            for (size_t i = 0; i < snapshot.vBounds.size(); i++) {
+                nCumulative += snapshot.vCounts[i];
+                out += strprintf("%s_bucket{le=\"%g\"} %u\n", name, snapshot.vBounds[i], nCumulative);
+            }
+            out += strprintf("%s_bucket{le=\"+Inf\"} %u\n", name, snapshot.nCount);
+            out += strprintf("%s_sum %g\n%s_count %u\n", name, snapshot.sum, name, snapshot.nCount);
+        }
+        return out;
+    }
+
+    Registry &GetRegistry() {
+        // Never destroyed, call sites keep references to the metrics in statics of their own
+        static Registry *registry = new Registry();
+        return *registry;
+    }
+
+} // namespace metrics
@@ -0,0 +1,146 @@
+// Copyright (c) 2025 The 405Coin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_METRICS_H
+#define BITCOIN_METRICS_H
+
+#include <sync.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+static const bool DEFAULT_HTTP_METRICS_ENABLE = false;
+
+/**
+ * In-process metrics, kept in memory and read through the getmetrics RPC or scraped from the /metrics HTTP endpoint
+ * in the Prometheus text format. Unlike statsClient nothing leaves the process unless it's asked for.
+ *
+ * Metrics are registered by name on first use and live as long as the process, so call sites keep a reference in a
+ * function local static:
+ *
+ *     static auto &histConnectBlock = metrics::GetRegistry().GetHistogram("connectblock_ms", "Time to connect a block");
+ *     metrics::HistogramTimer timer(histConnectBlock);
+ *
+ * Updating a metric is lock free.
+ */
+namespace metrics {
+
+    class Counter {
+    public:
+        void Inc(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+
+        uint64_t Get() const { return value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> value{0};
+    };
+
+    class Gauge {
+    public:
+        void Set(double v) { value.store(v, std::memory_order_relaxed); }
+
+        double Get() const { return value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<double> value{0};
+    };
+
+    /** Upper bounds of the default latency buckets, in milliseconds */
+    extern const std::vector<double> DEFAULT_LATENCY_BUCKETS_MS;
+
+    /** Counts observations into fixed buckets, quantiles are estimated by interpolating within a bucket */
+    class Histogram {
+    public:
+        struct Snapshot {
+            std::vector<double> vBounds;
+            //! Non-cumulative, one more than vBounds for the observations above the last bound
+            std::vector<uint64_t> vCounts;
+            uint64_t nCount{0};
+            double sum{0};
+
+            /** Estimated q-quantile (0 <= q <= 1), 0 when nothing was observed */
+            double Quantile(double q) const;
+        };
+
+        explicit Histogram(std::vector<double> bounds);
+
+        void Observe(double v);
+
+        Snapshot GetSnapshot() const;
+
+    private:
+        const std::vector<double> vBounds;
+        const std::unique_ptr<std::atomic<uint64_t>[]> counts;
+        std::atomic<double> sum{0};
+    };
+
+    /** Observes the time between construction and destruction in milliseconds */
+    class HistogramTimer {
+    public:
+        explicit HistogramTimer(Histogram &_histogram) :
+                histogram(_histogram), start(std::chrono::steady_clock::now()) {}
+
+        ~HistogramTimer() {
+            histogram.Observe(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+
+    private:
+        Histogram &histogram;
+        const std::chrono::steady_clock::time_point start;
+    };
+
+    class Registry {
+    public:
+        /** Returns the metric with this name, registering it on first use. The help text of the first call is kept. */
+        Counter &GetCounter(const std::string &name, const std::string &help);
+
+        Gauge &GetGauge(const std::string &name, const std::string &help);
+
+        Histogram &GetHistogram(const std::string &name, const std::string &help,
+                                const std::vector<double> &bounds = DEFAULT_LATENCY_BUCKETS_MS);
+
+        /** Prometheus text exposition format, each name is prefixed with "coin405_" */
+        std::string RenderPrometheus() const;
+
+        template<typename Callable>
+        void ForEachCounter(Callable &&func) const {
+            LOCK(cs);
+            for (const auto &p: mapCounters) func(p.first, *p.second.metric);
+        }
+
+        template<typename Callable>
+        void ForEachGauge(Callable &&func) const {
+            LOCK(cs);
+            for (const auto &p: mapGauges) func(p.first, *p.second.metric);
+        }
+
+        template<typename Callable>
+        void ForEachHistogram(Callable &&func) const {
+            LOCK(cs);
+            for (const auto &p: mapHistograms) func(p.first, *p.second.metric);
+        }
+
+    private:
+        template<typename T>
+        struct Entry {
+            std::string help;
+            std::unique_ptr<T> metric;
+        };
+
+        mutable Mutex cs;
+        std::map<std::string, Entry<Counter>> mapCounters GUARDED_BY(cs);
+        std::map<std::string, Entry<Gauge>> mapGauges GUARDED_BY(cs);
+        std::map<std::string, Entry<Histogram>> mapHistograms GUARDED_BY(cs);
+    };
+
+    Registry &GetRegistry();
+
+} // namespace metrics
+
+#endif // BITCOIN_METRICS_H
@@ -194,16 +194,6 @@ std::unique_ptr <CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript &s
     CMutableTransaction coinbaseTx;
     coinbaseTx.vin.resize(1);
     coinbaseTx.vin[0].prevout.SetNull();
-    coinbaseTx.vout.resize(1);
-    coinbaseTx.vout[0].scriptPubKey = scriptPubKeyIn;
-
-    // NOTE: unlike in bitcoin, we need to pass PREVIOUS block height here
-    CAmount normalBlockReward =
-            nFees + GetBlockSubsidy(pindexPrev->nBits, pindexPrev->nHeight, Params().GetConsensus());
-    CAmount blockRewardWithSpecialtx = normalBlockReward + nSpecialTxFees;
-
-    // Compute regular coinbase transaction.
-    coinbaseTx.vout[0].nValue = blockRewardWithSpecialtx;
 
     if (!fDIP0003Active_context) {
         coinbaseTx.vin[0].scriptSig = CScript() << nHeight << OP_0;
@@ -233,15 +223,8 @@ std::unique_ptr <CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript &s
         SetTxPayload(coinbaseTx, cbTx);
     }
 
-    // Update coinbase transaction with additional info about smartnode and governance payments,
-    // get some info back to pass to getblocktemplate
-    FillBlockPayments(coinbaseTx, nHeight, normalBlockReward, pblocktemplate->voutSmartnodePayments,
-                      pblocktemplate->voutSuperblockPayments, nSpecialTxFees);
-    FounderPayment founderPayment = chainparams.GetConsensus().nFounderPayment;
-    founderPayment.FillFounderPayment(coinbaseTx, nHeight, normalBlockReward, pblock->txoutFounder);
+    FillCoinbaseOutputs(coinbaseTx, *pblocktemplate, chainparams, pindexPrev, scriptPubKeyIn, nFees, nSpecialTxFees);
     pblock->vtx[0] = MakeTransactionRef(std::move(coinbaseTx));
-    pblocktemplate->vTxFees[0] = -nFees;
-    pblocktemplate->vSpecialTxFees[0] = -nSpecialTxFees;
 
 
     // Fill in header
@@ -266,6 +249,31 @@ std::unique_ptr <CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript &s
     return std::move(pblocktemplate);
 }
 
+void FillCoinbaseOutputs(CMutableTransaction &coinbaseTx, CBlockTemplate &blocktemplate, const CChainParams &chainparams,
+                         const CBlockIndex *pindexPrev, const CScript &scriptPubKeyIn, CAmount nFees,
+                         CAmount nSpecialTxFees) {
+    const int nHeight = pindexPrev->nHeight + 1;
+
+    // NOTE: unlike in bitcoin, we need to pass PREVIOUS block height here
+    CAmount normalBlockReward =
+            nFees + GetBlockSubsidy(pindexPrev->nBits, pindexPrev->nHeight, chainparams.GetConsensus());
+    CAmount blockRewardWithSpecialtx = normalBlockReward + nSpecialTxFees;
+
+    // Compute regular coinbase transaction.
+    coinbaseTx.vout.assign(1, CTxOut(blockRewardWithSpecialtx, scriptPubKeyIn));
+
+    // Update coinbase transaction with additional info about smartnode and governance payments,
+    // get some info back to pass to getblocktemplate
+    blocktemplate.voutSmartnodePayments.clear();
+    blocktemplate.voutSuperblockPayments.clear();
+    FillBlockPayments(coinbaseTx, nHeight, normalBlockReward, blocktemplate.voutSmartnodePayments,
+                      blocktemplate.voutSuperblockPayments, nSpecialTxFees);
+    FounderPayment founderPayment = chainparams.GetConsensus().nFounderPayment;
+    founderPayment.FillFounderPayment(coinbaseTx, nHeight, normalBlockReward, blocktemplate.block.txoutFounder);
+    blocktemplate.vTxFees[0] = -nFees;
+    blocktemplate.vSpecialTxFees[0] = -nSpecialTxFees;
+}
+
 void BlockAssembler::onlyUnconfirmed(CTxMemPool::setEntries &testSet) {
     for (CTxMemPool::setEntries::iterator iit = testSet.begin(); iit != testSet.end();) {
         // Only test txs not already in the block
@@ -508,6 +516,171 @@ void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpda
     }
 }
 
+//! Pending mempool additions beyond this are not worth appending, the next template is built from scratch
+static const size_t MAX_TEMPLATE_PENDING_TXS = 10000;
+
+BlockTemplateBuilder::BlockTemplateBuilder(CTxMemPool &mempool, const CChainParams &params) :
+        m_mempool(mempool), chainparams(params) {
+    connAdded = m_mempool.NotifyEntryAdded.connect(
+            std::bind(&BlockTemplateBuilder::TransactionAdded, this, std::placeholders::_1));
+    connRemoved = m_mempool.NotifyEntryRemoved.connect(
+            std::bind(&BlockTemplateBuilder::TransactionRemoved, this, std::placeholders::_1));
+}
+
+BlockTemplateBuilder::~BlockTemplateBuilder() {
+    connAdded.disconnect();
+    connRemoved.disconnect();
+}
+
+void BlockTemplateBuilder::TransactionAdded(const CTransactionRef &tx) {
+    LOCK(cs);
+    if (!pblocktemplate || fStale) {
+        return;
+    }
+    if (vAdded.size() >= MAX_TEMPLATE_PENDING_TXS) {
+        fStale = true;
+        vAdded.clear();
+        return;
+    }
+    vAdded.emplace_back(tx);
+}
+
+void BlockTemplateBuilder::TransactionRemoved(const CTransactionRef &tx) {
+    LOCK(cs);
+    if (setTemplateTx.count(tx->GetHash())) {
+        fStale = true;
+    }
+}
+
+std::unique_ptr <CBlockTemplate> BlockTemplateBuilder::GetTemplate(const CScript &scriptPubKeyIn) {
+    LOCK2(cs_main, m_mempool.cs);
+    LOCK(cs);
+
+    const CBlockIndex *pindexTip = ::ChainActive().Tip();
+    const int64_t nAge = GetTime() - nTemplateTime;
+    // Mempool changes which need a new template only get one every few seconds, like getblocktemplate did before
+    const bool fCanRebuild = nAge >= MIN_REBUILD_INTERVAL;
+    if (!pblocktemplate || pindexPrev != pindexTip || nAge > MAX_TEMPLATE_AGE || (fStale && fCanRebuild)) {
+        Rebuild(pindexTip, scriptPubKeyIn);
+    } else if (!vAdded.empty() && !fStale) {
+        int64_t nTimeStart = GetTimeMicros();
+        const size_t nTxBefore = pblocktemplate->block.vtx.size();
+        if (AppendTransactions()) {
+            LogPrint(BCLog::BENCHMARK, "%s: appended %u of %u transactions: %.2fms\n", __func__,
+                     pblocktemplate->block.vtx.size() - nTxBefore, vAdded.size(),
+                     0.001 * (GetTimeMicros() - nTimeStart));
+            vAdded.clear();
+        } else if (fCanRebuild) {
+            Rebuild(pindexTip, scriptPubKeyIn);
+        } else {
+            // The transactions appended so far are kept, the rest waits for the rebuild
+            fStale = true;
+        }
+    }
+
+    // The template keeps the coinbase it was built with, the outputs depend on the caller and the fees
+    auto result = std::make_unique<CBlockTemplate>(*pblocktemplate);
+    CMutableTransaction coinbaseTx(*result->block.vtx[0]);
+    FillCoinbaseOutputs(coinbaseTx, *result, chainparams, pindexPrev, scriptPubKeyIn, nFees, nSpecialTxFees);
+    result->block.vtx[0] = MakeTransactionRef(std::move(coinbaseTx));
+    result->vTxSigOps[0] = GetLegacySigOpCount(*result->block.vtx[0]);
+    UpdateTime(&result->block, chainparams.GetConsensus(), pindexPrev);
+    return result;
+}
+
+void BlockTemplateBuilder::Rebuild(const CBlockIndex *pindexTip, const CScript &scriptPubKeyIn) {
+    pblocktemplate.reset();
+    pindexPrev = nullptr;
+    fStale = false;
+    vAdded.clear();
+    setTemplateTx.clear();
+    view.reset();
+
+    // Throws if the template isn't valid, the next call tries again
+    pblocktemplate = BlockAssembler(m_mempool, chainparams).CreateNewBlock(scriptPubKeyIn);
+    pindexPrev = pindexTip;
+    nTemplateTime = GetTime();
+    nLockTimeCutoff = (STANDARD_LOCKTIME_VERIFY_FLAGS & LOCKTIME_MEDIAN_TIME_PAST)
+                      ? pindexPrev->GetMedianTimePast()
+                      : pblocktemplate->block.GetBlockTime();
+
+    // Same accounting as BlockAssembler, with the space reserved for the coinbase
+    nBlockSize = 1000;
+    nBlockSigOps = 100;
+    nFees = -pblocktemplate->vTxFees[0];
+    nSpecialTxFees = -pblocktemplate->vSpecialTxFees[0];
+    for (size_t i = 1; i < pblocktemplate->block.vtx.size(); i++) {
+        const CTransaction &tx = *pblocktemplate->block.vtx[i];
+        setTemplateTx.insert(tx.GetHash());
+        nBlockSize += tx.GetTotalSize();
+        nBlockSigOps += pblocktemplate->vTxSigOps[i];
+    }
+}
+
+bool BlockTemplateBuilder::AppendTransactions() {
+    const int nHeight = pindexPrev->nHeight + 1;
+    const BlockAssembler assembler(m_mempool, chainparams);
+    const unsigned int nBlockMaxSize = assembler.GetBlockMaxSize();
+    const CFeeRate blockMinFeeRate = assembler.GetBlockMinFeeRate();
+
+    if (!view) {
+        view = std::make_unique<CCoinsViewCache>(&::ChainstateActive().CoinsTip());
+        for (size_t i = 1; i < pblocktemplate->block.vtx.size(); i++) {
+            UpdateCoins(*pblocktemplate->block.vtx[i], *view, nHeight);
+        }
+    }
+
+    for (const CTransactionRef &ptx: vAdded) {
+        const CTransaction &tx = *ptx;
+        auto it = m_mempool.mapTx.find(tx.GetHash());
+        if (it == m_mempool.mapTx.end() || setTemplateTx.count(tx.GetHash())) {
+            continue;
+        }
+        // Special transactions change the merkle roots of the CbTx
+        if (tx.nType != TRANSACTION_NORMAL) {
+            return false;
+        }
+        // Left out like by BlockAssembler, a child paying for it needs a new template
+        if (it->GetModifiedFee() < blockMinFeeRate.GetFee(it->GetTxSize())) {
+            continue;
+        }
+        for (const CTxIn &txin: tx.vin) {
+            if (m_mempool.mapTx.count(txin.prevout.hash) && !setTemplateTx.count(txin.prevout.hash)) {
+                return false;
+            }
+        }
+        if (nBlockSize + it->GetTxSize() >= nBlockMaxSize ||
+            nBlockSigOps + it->GetSigOpCount() >= MaxBlockSigOps(fDIP0001ActiveAtTip)) {
+            return false;
+        }
+        if (!IsFinalTx(tx, nHeight, nLockTimeCutoff) || !llmq::chainLocksHandler->IsTxSafeForMining(tx.GetHash())) {
+            continue;
+        }
+
+        // Scripts were checked when the transaction entered the mempool
+        CValidationState state;
+        CAmount txfee = 0;
+        CAmount specialTxFee = 0;
+        if (!Consensus::CheckTxInputs(tx, state, *view, nHeight, txfee, specialTxFee)) {
+            LogPrint(BCLog::MEMPOOL, "%s: %s doesn't fit the template: %s\n", __func__, tx.GetHash().ToString(),
+                     FormatStateMessage(state));
+            return false;
+        }
+        UpdateCoins(tx, *view, nHeight);
+
+        pblocktemplate->block.vtx.emplace_back(ptx);
+        pblocktemplate->vTxFees.push_back(it->GetFee());
+        pblocktemplate->vSpecialTxFees.push_back(it->GetSpecialTxFee());
+        pblocktemplate->vTxSigOps.push_back(it->GetSigOpCount());
+        setTemplateTx.insert(tx.GetHash());
+        nBlockSize += it->GetTxSize();
+        nBlockSigOps += it->GetSigOpCount();
+        nFees += it->GetFee();
+        nSpecialTxFees += it->GetSpecialTxFee();
+    }
+    return true;
+}
+
 void IncrementExtraNonce(CBlock *pblock, const CBlockIndex *pindexPrev, unsigned int &nExtraNonce) {
     // Update nExtraNonce
     static uint256 hashPrevBlock;
@@ -640,10 +813,11 @@ void static Coin405Miner(const CChainParams& chainparams, NodeContext& node) {
             //
             int64_t nStart = GetTime();
             arith_uint256 hashTarget = arith_uint256().SetCompact(pblock->nBits);
+            const GRSchedule schedule(pblock->hashPrevBlock);
             while (true) {
                 uint256 hash;
                 while (true) {
-                    hash = pblock->ComputeHash();
+                    hash = pblock->ComputeHash(schedule);
                     if (UintToArith256(hash) <= hashTarget) {
                         // Found a solution
                         SetThreadPriority(THREAD_PRIORITY_NORMAL);
@@ -7,12 +7,15 @@
 #define BITCOIN_MINER_H
 
 #include <primitives/block.h>
+#include <saltedhasher.h>
+#include <sync.h>
 #include <txmempool.h>
 #include <validation.h>
 #include <node/context.h>
 
 #include <stdint.h>
 #include <memory>
+#include <unordered_set>
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 
@@ -20,6 +23,8 @@ class CBlockIndex;
 
 class CChainParams;
 
+class CCoinsViewCache;
+
 class CConnman;
 
 class CScript;
@@ -168,6 +173,10 @@ public:
     /** Construct a new block template with coinbase to scriptPubKeyIn */
     std::unique_ptr <CBlockTemplate> CreateNewBlock(const CScript &scriptPubKeyIn);
 
+    unsigned int GetBlockMaxSize() const { return nBlockMaxSize; }
+
+    const CFeeRate &GetBlockMinFeeRate() const { return blockMinFeeRate; }
+
 private:
     // utility functions
     /** Clear the block's state and prepare for assembling a new block */
@@ -219,6 +228,71 @@ private:
     .cs);
 };
 
+/**
+ * Keeps the template of the next block ready for getblocktemplate and the stratum server.
+ *
+ * Transactions entering the mempool are appended to the current template when all their unconfirmed parents are
+ * already in it, and only they are checked, against the coins of the template. Anything else builds a new template
+ * with BlockAssembler::CreateNewBlock: a new tip, a template transaction leaving the mempool, a special transaction
+ * (they change the CbTx), a parent outside of the template, a full block, or a template older than
+ * MAX_TEMPLATE_AGE seconds, which lets better packages in.
+ */
+class BlockTemplateBuilder {
+public:
+    static constexpr int64_t MAX_TEMPLATE_AGE = 60;
+    //! Seconds a template is kept although mempool changes need a rebuild, like getblocktemplate always did
+    static constexpr int64_t MIN_REBUILD_INTERVAL = 5;
+
+    BlockTemplateBuilder(CTxMemPool &mempool, const CChainParams &params);
+
+    ~BlockTemplateBuilder();
+
+    /** Template for a block on the current tip, with the coinbase paying to scriptPubKeyIn */
+    std::unique_ptr<CBlockTemplate> GetTemplate(const CScript &scriptPubKeyIn);
+
+private:
+    CTxMemPool &m_mempool;
+    const CChainParams &chainparams;
+
+    Mutex cs;
+    std::unique_ptr<CBlockTemplate> pblocktemplate GUARDED_BY(cs);
+    const CBlockIndex *pindexPrev GUARDED_BY(cs){nullptr};
+    int64_t nTemplateTime GUARDED_BY(cs){0};
+    //! A transaction of the template left the mempool
+    bool fStale GUARDED_BY(cs){false};
+    //! Transactions which entered the mempool since the template was built, in order
+    std::vector<CTransactionRef> vAdded GUARDED_BY(cs);
+    std::unordered_set<uint256, StaticSaltedHasher> setTemplateTx GUARDED_BY(cs);
+    //! Coins after the template transactions, made on the first append
+    std::unique_ptr<CCoinsViewCache> view GUARDED_BY(cs);
+    int64_t nLockTimeCutoff GUARDED_BY(cs){0};
+    uint64_t nBlockSize GUARDED_BY(cs){0};
+    unsigned int nBlockSigOps GUARDED_BY(cs){0};
+    CAmount nFees GUARDED_BY(cs){0};
+    CAmount nSpecialTxFees GUARDED_BY(cs){0};
+
+    boost::signals2::scoped_connection connAdded;
+    boost::signals2::scoped_connection connRemoved;
+
+    void TransactionAdded(const CTransactionRef &tx);
+
+    void TransactionRemoved(const CTransactionRef &tx);
+
+    void Rebuild(const CBlockIndex *pindexTip, const CScript &scriptPubKeyIn)
+    EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_mempool.cs, cs);
+
+    /** Appends vAdded to the template, returns false if a new template is needed */
+    bool AppendTransactions() EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_mempool.cs, cs);
+};
+
+/**
+ * Sets the outputs of a coinbase paying the block reward with nFees to scriptPubKeyIn, and the smartnode, superblock
+ * and founder payments. Its inputs and payload are left alone.
+ */
+void FillCoinbaseOutputs(CMutableTransaction &coinbaseTx, CBlockTemplate &blocktemplate, const CChainParams &chainparams,
+                         const CBlockIndex *pindexPrev, const CScript &scriptPubKeyIn, CAmount nFees,
+                         CAmount nSpecialTxFees);
+
 /** Modify the extranonce in a block */
 void IncrementExtraNonce(CBlock *pblock, const CBlockIndex *pindexPrev, unsigned int &nExtraNonce);
 
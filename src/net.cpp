@@ -597,6 +597,10 @@ void CNode::copyStats(CNodeStats &stats, const std::vector<bool> &m_asmap) {
         X(mapRecvBytesPerMsgCmd);
         X(nRecvBytes);
     }
+    {
+        LOCK(cs_vProcessMsg);
+        X(mapProcessTimePerMsgCmd);
+    }
     X(fWhitelisted);
 
     // It is common for nodes with good ping times to suddenly become lagged,
@@ -1831,7 +1835,7 @@ size_t CConnman::SocketRecvData(CNode *pnode) {
                 pnode->nProcessQueueSize += nSizeAdded;
                 pnode->fPauseRecv = pnode->nProcessQueueSize > nReceiveFloodSize;
             }
-            WakeMessageHandler();
+            WakeMessageHandler(pnode);
         }
     } else if (nBytes == 0) {
         // socket closed gracefully
@@ -1878,11 +1882,25 @@ void CConnman::ThreadSocketHandler() {
 }
 
 void CConnman::WakeMessageHandler() {
+    for (const auto &handler: vMessageHandlers) {
+        {
+            LOCK(handler->mutexMsgProc);
+            handler->fMsgProcWake = true;
+        }
+        handler->condMsgProc.notify_one();
+    }
+}
+
+void CConnman::WakeMessageHandler(const CNode *pnode) {
+    if (vMessageHandlers.empty()) {
+        return;
+    }
+    MessageHandler &handler = *vMessageHandlers[pnode->GetId() % vMessageHandlers.size()];
     {
-        LOCK(mutexMsgProc);
-        fMsgProcWake = true;
+        LOCK(handler.mutexMsgProc);
+        handler.fMsgProcWake = true;
     }
-    condMsgProc.notify_one();
+    handler.condMsgProc.notify_one();
 }
 
 void CConnman::WakeSelect() {
@@ -2513,10 +2531,12 @@ void CConnman::OpenSmartnodeConnection(const CAddress &addrConnect, bool probe)
     OpenNetworkConnection(addrConnect, false, nullptr, nullptr, false, false, false, true, probe);
 }
 
-void CConnman::ThreadMessageHandler() {
+void CConnman::ThreadMessageHandler(int nWorker) {
+    MessageHandler &handler = *vMessageHandlers[nWorker];
+    const size_t nWorkers = vMessageHandlers.size();
     int64_t nLastSendMessagesTimeSmartnodes = 0;
 #ifdef ENABLE_WALLET
-    bool syncComplete = false;
+    bool syncComplete = nWorker != 0;
 #endif
     while (!flagInterruptMsgProc) {
         std::vector < CNode * > vNodesCopy = CopyNodeVector();
@@ -2540,7 +2560,7 @@ void CConnman::ThreadMessageHandler() {
 #endif
 
         for (CNode *pnode: vNodesCopy) {
-            if (pnode->fDisconnect)
+            if (pnode->fDisconnect || pnode->GetId() % nWorkers != (size_t) nWorker)
                 continue;
 
             // Receive messages
@@ -2560,13 +2580,14 @@ void CConnman::ThreadMessageHandler() {
 
         ReleaseNodeVector(vNodesCopy);
 
-        WAIT_LOCK(mutexMsgProc, lock);
+        WAIT_LOCK(handler.mutexMsgProc, lock);
         if (!fMoreWork) {
-            condMsgProc.wait_until(lock, std::chrono::steady_clock::now() + std::chrono::milliseconds(100), [this]()
-            EXCLUSIVE_LOCKS_REQUIRED(mutexMsgProc)
-            { return fMsgProcWake; });
+            handler.condMsgProc.wait_until(lock, std::chrono::steady_clock::now() + std::chrono::milliseconds(100),
+                                           [&handler]()
+            EXCLUSIVE_LOCKS_REQUIRED(handler.mutexMsgProc)
+            { return handler.fMsgProcWake; });
         }
-        fMsgProcWake = false;
+        handler.fMsgProcWake = false;
     }
 }
 
@@ -2868,9 +2889,10 @@ bool CConnman::Start(CScheduler &scheduler, const Options &connOptions) {
     interruptNet.reset();
     flagInterruptMsgProc = false;
 
-    {
-        LOCK(mutexMsgProc);
-        fMsgProcWake = false;
+    // The socket thread wakes the message handlers, so they must exist before it starts
+    vMessageHandlers.clear();
+    for (int i = 0; i < nMsgHandThreads; i++) {
+        vMessageHandlers.emplace_back(MakeUnique<MessageHandler>());
     }
 
 #ifdef USE_WAKEUP_PIPE
@@ -2948,9 +2970,16 @@ bool CConnman::Start(CScheduler &scheduler, const Options &connOptions) {
                                                  std::function<void()>(
                                                          std::bind(&CConnman::ThreadOpenSmartnodeConnections, this)));
 
-    // Process messages
-    threadMessageHandler = std::thread(&TraceThread < std::function < void() > > , "msghand",
-                                       std::function<void()>(std::bind(&CConnman::ThreadMessageHandler, this)));
+    // Process messages, the first thread keeps the historical name
+    for (int i = 0; i < nMsgHandThreads; i++) {
+        const std::string strName = i == 0 ? "msghand" : strprintf("msghand.%d", i);
+        vMessageHandlers[i]->thread = std::thread(&TraceThread < std::function < void() > > , strName,
+                                                  std::function<void()>(
+                                                          std::bind(&CConnman::ThreadMessageHandler, this, i)));
+    }
+    if (nMsgHandThreads > 1) {
+        LogPrintf("Using %d message handler threads\n", nMsgHandThreads);
+    }
 
     // Dump network addresses
     scheduler.scheduleEvery(std::bind(&CConnman::DumpAddresses, this), DUMP_PEERS_INTERVAL * 1000);
@@ -2979,11 +3008,15 @@ void CExplicitNetCleanup::callCleanup() {
 }
 
 void CConnman::Interrupt() {
-    {
-        LOCK(mutexMsgProc);
-        flagInterruptMsgProc = true;
+    flagInterruptMsgProc = true;
+    for (const auto &handler: vMessageHandlers) {
+        {
+            // Don't let a handler about to wait sleep through its timeout
+            LOCK(handler->mutexMsgProc);
+            handler->fMsgProcWake = true;
+        }
+        handler->condMsgProc.notify_all();
     }
-    condMsgProc.notify_all();
 
     interruptNet();
     InterruptSocks5(true);
@@ -3002,8 +3035,10 @@ void CConnman::Interrupt() {
 }
 
 void CConnman::Stop() {
-    if (threadMessageHandler.joinable())
-        threadMessageHandler.join();
+    for (const auto &handler: vMessageHandlers) {
+        if (handler->thread.joinable())
+            handler->thread.join();
+    }
     if (threadOpenSmartnodeConnections.joinable())
         threadOpenSmartnodeConnections.join();
     if (threadOpenConnections.joinable())
@@ -3584,6 +3619,9 @@ CNode::CNode(NodeId idIn, ServiceFlags nLocalServicesIn, int nMyStartingHeightIn
     for (const std::string &msg: getAllNetMessageTypes())
         mapRecvBytesPerMsgCmd[msg] = 0;
     mapRecvBytesPerMsgCmd[NET_MESSAGE_COMMAND_OTHER] = 0;
+    for (const std::string &msg: getAllNetMessageTypes())
+        mapProcessTimePerMsgCmd[msg] = 0;
+    mapProcessTimePerMsgCmd[NET_MESSAGE_COMMAND_OTHER] = 0;
 
     if (fLogIPs) {
         LogPrint(BCLog::NET, "Added connection to %s peer=%d\n", addrName, id);
@@ -3592,6 +3630,33 @@ CNode::CNode(NodeId idIn, ServiceFlags nLocalServicesIn, int nMyStartingHeightIn
     }
 }
 
+std::vector <CAddress> CNode::TakeAddressesToSend() {
+    LOCK(cs_addrToSend);
+    std::vector <CAddress> vAddr;
+    vAddr.reserve(vAddrToSend.size());
+    for (const CAddress &addr: vAddrToSend) {
+        if (!addrKnown.contains(addr.GetKey())) {
+            addrKnown.insert(addr.GetKey());
+            vAddr.push_back(addr);
+        }
+    }
+    vAddrToSend.clear();
+    // we only send the big addr message once
+    if (vAddrToSend.capacity() > 40)
+        vAddrToSend.shrink_to_fit();
+    return vAddr;
+}
+
+void CNode::AddProcessTime(const std::string &strCommand, int64_t nTimeMicros) {
+    LOCK(cs_vProcessMsg);
+    // to prevent a memory DOS, only allow valid commands
+    auto it = mapProcessTimePerMsgCmd.find(strCommand);
+    if (it == mapProcessTimePerMsgCmd.end())
+        it = mapProcessTimePerMsgCmd.find(NET_MESSAGE_COMMAND_OTHER);
+    assert(it != mapProcessTimePerMsgCmd.end());
+    it->second += nTimeMicros;
+}
+
 CNode::~CNode() {
     CloseSocket(hSocket);
 }
@@ -3601,7 +3666,8 @@ bool CConnman::NodeFullyConnected(const CNode *pnode) {
 }
 
 void CConnman::PushMessage(CNode *pnode, CSerializedNetMsg &&msg) {
-    size_t nMessageSize = msg.data.size();
+    const std::vector<unsigned char> &payload = msg.shared_data ? *msg.shared_data : msg.data;
+    size_t nMessageSize = payload.size();
     size_t nTotalSize = nMessageSize + CMessageHeader::HEADER_SIZE;
     LogPrint(BCLog::NET, "sending %s (%d bytes) peer=%d\n", SanitizeString(msg.command), nMessageSize, pnode->GetId());
     statsClient.count("bandwidth.message." + SanitizeString(msg.command.c_str()) + ".bytesSent", nTotalSize, 1.0f);
@@ -3609,7 +3675,7 @@ void CConnman::PushMessage(CNode *pnode, CSerializedNetMsg &&msg) {
 
     std::vector<unsigned char> serializedHeader;
     serializedHeader.reserve(CMessageHeader::HEADER_SIZE);
-    uint256 hash = Hash(msg.data.data(), msg.data.data() + nMessageSize);
+    uint256 hash = Hash(payload.data(), payload.data() + nMessageSize);
     CMessageHeader hdr(Params().MessageStart(), msg.command.c_str(), nMessageSize);
     memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
 
@@ -3626,9 +3692,14 @@ void CConnman::PushMessage(CNode *pnode, CSerializedNetMsg &&msg) {
 
         if (pnode->nSendSize > nSendBufferMaxSize)
             pnode->fPauseSend = true;
-        pnode->vSendMsg.push_back(std::move(serializedHeader));
-        if (nMessageSize)
-            pnode->vSendMsg.push_back(std::move(msg.data));
+        pnode->vSendMsg.emplace_back(std::move(serializedHeader));
+        if (nMessageSize) {
+            if (msg.shared_data) {
+                pnode->vSendMsg.emplace_back(std::move(msg.shared_data));
+            } else {
+                pnode->vSendMsg.emplace_back(std::move(msg.data));
+            }
+        }
         pnode->nSendMsgSize = pnode->vSendMsg.size();
 
         {
@@ -106,6 +106,9 @@ static const int64_t DEFAULT_PEER_CONNECT_TIMEOUT = 60;
 static const bool DEFAULT_FORCEDNSSEED = false;
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 5 * 1000;
 static const size_t DEFAULT_MAXSENDBUFFER = 1 * 1000;
+/** -msghandthreads default, peers are spread over the message handler threads */
+static const int DEFAULT_MSGHAND_THREADS = 1;
+static const int MAX_MSGHAND_THREADS = 16;
 
 #if defined USE_KQUEUE
 #define DEFAULT_SOCKETEVENTS "kqueue"
@@ -143,9 +146,27 @@ struct CSerializedNetMsg {
     CSerializedNetMsg &operator=(const CSerializedNetMsg &) = delete;
 
     std::vector<unsigned char> data;
+    //! Sent instead of data if set, without copying it, e.g. a buffer which is also cached
+    std::shared_ptr<const std::vector<unsigned char>> shared_data;
     std::string command;
 };
 
+/** Part of a message in the send queue of a node, which either owns its bytes or shares them */
+class CSendMsgPart {
+public:
+    explicit CSendMsgPart(std::vector<unsigned char> &&dataIn) : owned_data(std::move(dataIn)) {}
+
+    explicit CSendMsgPart(std::shared_ptr<const std::vector<unsigned char>> dataIn) : shared_data(std::move(dataIn)) {}
+
+    const unsigned char *data() const { return shared_data ? shared_data->data() : owned_data.data(); }
+
+    size_t size() const { return shared_data ? shared_data->size() : owned_data.size(); }
+
+private:
+    std::vector<unsigned char> owned_data;
+    std::shared_ptr<const std::vector<unsigned char>> shared_data;
+};
+
 
 class NetEventsInterface;
 
@@ -191,6 +212,7 @@ public:
         std::vector <std::string> m_added_nodes;
         SocketEventsMode socketEventsMode = SOCKETEVENTS_SELECT;
         std::vector<bool> m_asmap;
+        int nMsgHandThreads = DEFAULT_MSGHAND_THREADS;
     };
 
     void Init(const Options &connOptions) {
@@ -218,6 +240,7 @@ public:
             vAddedNodes = connOptions.m_added_nodes;
         }
         socketEventsMode = connOptions.socketEventsMode;
+        nMsgHandThreads = std::max(1, std::min(connOptions.nMsgHandThreads, MAX_MSGHAND_THREADS));
     }
 
     CConnman(uint64_t seed0, uint64_t seed1);
@@ -506,8 +529,12 @@ public:
 
     unsigned int GetReceiveFloodSize() const;
 
+    /** Wakes all message handler threads */
     void WakeMessageHandler();
 
+    /** Wakes the message handler thread the peer is pinned to */
+    void WakeMessageHandler(const CNode *pnode);
+
     void WakeSelect();
 
     /** Attempts to obfuscate tx time through exponentially distributed emitting.
@@ -540,7 +567,7 @@ private:
 
     void ThreadOpenConnections(std::vector <std::string> connect);
 
-    void ThreadMessageHandler();
+    void ThreadMessageHandler(int nWorker);
 
     void AcceptConnection(const ListenSocket &hListenSocket);
 
@@ -700,12 +727,21 @@ private:
     /** SipHasher seeds for deterministic randomness */
     const uint64_t nSeed0, nSeed1;
 
-    /** flag for waking the message processor. */
-    bool fMsgProcWake
-    GUARDED_BY(mutexMsgProc);
+    /**
+     * A message handler thread. Each peer is pinned to one of them by its id, so the messages of a peer are still
+     * processed one at a time and in order, while a slow message only holds up the peers sharing its thread.
+     */
+    struct MessageHandler {
+        std::thread thread;
+        std::condition_variable condMsgProc;
+        Mutex mutexMsgProc;
+        /** flag for waking the message processor. */
+        bool fMsgProcWake GUARDED_BY(mutexMsgProc){false};
+    };
 
-    std::condition_variable condMsgProc;
-    Mutex mutexMsgProc;
+    int nMsgHandThreads;
+    /** Created by Start() and kept until destruction, as the socket thread and validation callbacks wake them */
+    std::vector <std::unique_ptr<MessageHandler>> vMessageHandlers;
     std::atomic<bool> flagInterruptMsgProc{false};
 
     CThreadInterrupt interruptNet;
@@ -739,7 +775,6 @@ private:
     std::thread threadOpenAddedConnections;
     std::thread threadOpenConnections;
     std::thread threadOpenSmartnodeConnections;
-    std::thread threadMessageHandler;
 
     /** flag for deciding to connect to an extra outbound peer,
      *  in excess of nMaxOutbound
@@ -868,6 +903,8 @@ public:
     mapMsgCmdSize mapSendBytesPerMsgCmd;
     uint64_t nRecvBytes;
     mapMsgCmdSize mapRecvBytesPerMsgCmd;
+    //! Microseconds spent processing each message command
+    mapMsgCmdSize mapProcessTimePerMsgCmd;
     bool fWhitelisted;
     int64_t m_ping_usec;
     int64_t m_ping_wait_usec;
@@ -950,7 +987,7 @@ public:
     size_t nSendOffset; // offset inside the first vSendMsg already sent
     uint64_t nSendBytes
     GUARDED_BY(cs_vSend);
-    std::list <std::vector<unsigned char>> vSendMsg
+    std::list <CSendMsgPart> vSendMsg
     GUARDED_BY(cs_vSend);
     std::atomic <size_t> nSendMsgSize;
     RecursiveMutex cs_vSend;
@@ -961,6 +998,8 @@ public:
     std::list <CNetMessage> vProcessMsg
     GUARDED_BY(cs_vProcessMsg);
     size_t nProcessQueueSize;
+    mapMsgCmdSize mapProcessTimePerMsgCmd
+    GUARDED_BY(cs_vProcessMsg);
 
     RecursiveMutex cs_sendProcessing;
 
@@ -1051,8 +1090,12 @@ public:
     std::atomic<int> nStartingHeight;
 
     // flood relay
-    std::vector <CAddress> vAddrToSend;
-    CRollingBloomFilter addrKnown;
+    //! Other peers' message handlers relay addresses to this peer, possibly on other threads (-msghandthreads)
+    RecursiveMutex cs_addrToSend;
+    std::vector <CAddress> vAddrToSend
+    GUARDED_BY(cs_addrToSend);
+    CRollingBloomFilter addrKnown
+    GUARDED_BY(cs_addrToSend);
     bool fGetAddr;
     std::set <uint256> setKnown;
     int64_t nNextAddrSend
@@ -1213,10 +1256,12 @@ public:
 
 
     void AddAddressKnown(const CAddress &_addr) {
+        LOCK(cs_addrToSend);
         addrKnown.insert(_addr.GetKey());
     }
 
     void PushAddress(const CAddress &_addr, FastRandomContext &insecure_rand) {
+        LOCK(cs_addrToSend);
         // Known checking here is only to save space from duplicates.
         // SendMessages will filter it again for knowns that were added
         // after addresses were pushed.
@@ -1229,6 +1274,14 @@ public:
         }
     }
 
+    //! Addresses pushed since the last call which the peer doesn't know yet, they are marked as known
+    std::vector <CAddress> TakeAddressesToSend();
+
+    void ClearAddressesToSend() {
+        LOCK(cs_addrToSend);
+        vAddrToSend.clear();
+    }
+
 
     void AddInventoryKnown(const CInv &inv) {
         AddInventoryKnown(inv.hash);
@@ -1272,6 +1325,9 @@ public:
 
     void copyStats(CNodeStats &stats, const std::vector<bool> &m_asmap);
 
+    /** Accounts the time spent processing a message, unknown commands are counted as NET_MESSAGE_COMMAND_OTHER */
+    void AddProcessTime(const std::string &strCommand, int64_t nTimeMicros);
+
     ServiceFlags GetLocalServices() const {
         return nLocalServices;
     }
@@ -12,6 +12,7 @@
 #include <chainparams.h>
 #include <consensus/validation.h>
 #include <hash.h>
+#include <index/blockfilterindex.h>
 #include <merkleblock.h>
 #include <netmessagemaker.h>
 #include <netbase.h>
@@ -26,6 +27,7 @@
 #include <txdb.h>
 #include <index/txindex.h>
 #include <txmempool.h>
+#include <txorphanage.h>
 #include <ui_interface.h>
 #include <util/system.h>
 #include <util/moneystr.h>
@@ -58,8 +60,11 @@
 #include <llmq/quorums_signing.h>
 #include <llmq/quorums_signing_shares.h>
 
+#include <metrics.h>
 #include <statsd_client.h>
 
+#include <list>
+
 #if defined(NDEBUG)
 # error "405Coin Core cannot be compiled without assertions."
 #endif
@@ -93,13 +98,11 @@ static_assert(INBOUND_PEER_TX_DELAY
 "To preserve security, MAX_GETDATA_RANDOM_DELAY should not exceed INBOUND_PEER_DELAY");
 /** Limit to avoid sending big packets. Not used in processing incoming GETDATA for compatibility */
 static const unsigned int MAX_GETDATA_SZ = 1000;
+/** Maximum number of compact filters that may be requested with one getcfilters. See BIP 157. */
+static constexpr uint32_t MAX_GETCFILTERS_SIZE = 1000;
+/** Maximum number of cf hashes that may be requested with one getcfheaders. See BIP 157. */
+static constexpr uint32_t MAX_GETCFHEADERS_SIZE = 2000;
 
-/** Expiration time for orphan transactions in seconds */
-static constexpr int64_t
-ORPHAN_TX_EXPIRE_TIME = 20 * 60;
-/** Minimum time between orphan transactions expire time checks in seconds */
-static constexpr int64_t
-ORPHAN_TX_EXPIRE_INTERVAL = 5 * 60;
 /** Headers download timeout expressed in microseconds
  *  Timeout = base + per_header * (expected number of headers) */
 static constexpr int64_t
@@ -133,21 +136,8 @@ static constexpr int STALE_RELAY_AGE_LIMIT = 30 * 24 * 60 * 60;
 /// limiting block relay. Set to one week, denominated in seconds.
 static constexpr int HISTORICAL_BLOCK_AGE = 7 * 24 * 60 * 60;
 
-struct COrphanTx {
-    // When modifying, adapt the copy of this definition in tests/DoS_tests.
-    CTransactionRef tx;
-    NodeId fromPeer;
-    int64_t nTimeExpire;
-    size_t nTxSize;
-};
-static RecursiveMutex g_cs_orphans;
-std::map <uint256, COrphanTx> mapOrphanTransactions
-GUARDED_BY(g_cs_orphans);
-
-size_t nMapOrphanTransactionsSize = 0;
-
-void EraseOrphansFor(NodeId peer);
-
+/** Storage for orphan information */
+static TxOrphanage g_orphanage;
 
 /** Average delay between local address broadcasts. */
 static constexpr unsigned int AVG_LOCAL_ADDRESS_BROADCAST_INTERVAL = 24 * 60 * 60;
@@ -238,16 +228,6 @@ namespace {
     std::deque <std::pair<int64_t, MapRelay::iterator>> vRelayExpiration
     GUARDED_BY(cs_main);
 
-    struct IteratorComparator {
-        template<typename I>
-        bool operator()(const I &a, const I &b) const {
-            return &(*a) < &(*b);
-        }
-    };
-
-    std::map <COutPoint, std::set<std::map<uint256, COrphanTx>::iterator, IteratorComparator>> mapOrphanTransactionsByPrev
-    GUARDED_BY(g_cs_orphans);
-
     static size_t vExtraTxnForCompactIt
     GUARDED_BY(g_cs_orphans) = 0;
     static std::vector <std::pair<uint256, CTransactionRef>> vExtraTxnForCompact
@@ -982,7 +962,10 @@ void PeerLogicValidation::FinalizeNode(NodeId nodeid, bool &fUpdateConnectionTim
     for (const QueuedBlock &entry: state->vBlocksInFlight) {
         mapBlocksInFlight.erase(entry.hash);
     }
-    EraseOrphansFor(nodeid);
+    {
+        LOCK(g_cs_orphans);
+        g_orphanage.EraseForPeer(nodeid);
+    }
     nPreferredDownload -= state->fPreferredDownload;
     nPeersWithValidatedDownloads -= (state->nBlocksInFlightValidHeaders != 0);
     assert(nPeersWithValidatedDownloads >= 0);
@@ -1019,7 +1002,7 @@ bool GetNodeStateStats(NodeId nodeid, CNodeStateStats &stats) {
 
 //////////////////////////////////////////////////////////////////////////////
 //
-// mapOrphanTransactions
+// orphan transactions
 //
 
 void AddToCompactExtraTransactions(const CTransactionRef &tx)
@@ -1035,120 +1018,6 @@ EXCLUSIVE_LOCKS_REQUIRED(g_cs_orphans)
         vExtraTxnForCompactIt = (vExtraTxnForCompactIt + 1) % max_extra_txn;
         }
 
-bool AddOrphanTx(const CTransactionRef &tx, NodeId peer)
-
-EXCLUSIVE_LOCKS_REQUIRED(g_cs_orphans)
-        {
-                const uint256& hash = tx->GetHash();
-                if (mapOrphanTransactions.count(hash))
-                return false;
-
-                // Ignore big transactions, to avoid a
-                // send-big-orphans memory exhaustion attack. If a peer has a legitimate
-                // large transaction with a missing parent then we assume
-                // it will rebroadcast it later, after the parent transaction(s)
-                // have been mined or received.
-                // 100 orphans, each of which is at most 99,999 bytes big is
-                // at most 10 megabytes of orphans and somewhat more byprev index (in the worst case):
-                unsigned int sz = GetSerializeSize(*tx, SER_NETWORK, CTransaction::CURRENT_VERSION);
-                if (sz > MAX_STANDARD_TX_SIZE)
-                {
-                    LogPrint(BCLog::MEMPOOL, "ignoring large orphan tx (size: %u, hash: %s)\n", sz, hash.ToString());
-                    return false;
-                }
-
-                auto ret = mapOrphanTransactions.emplace(hash, COrphanTx{
-                    tx, peer, GetTime() + ORPHAN_TX_EXPIRE_TIME, sz
-                });
-                assert(ret.second);
-                for (const CTxIn& txin : tx->vin) {
-                    mapOrphanTransactionsByPrev[txin.prevout].insert(ret.first);
-                }
-
-                AddToCompactExtraTransactions(tx);
-
-                nMapOrphanTransactionsSize += sz;
-
-                LogPrint(BCLog::MEMPOOL, "stored orphan tx %s (mapsz %u outsz %u)\n", hash.ToString(), mapOrphanTransactions.size(), mapOrphanTransactionsByPrev.size());
-                statsClient.inc("transactions.orphans.add", 1.0f);
-                statsClient.gauge("transactions.orphans", mapOrphanTransactions.size());
-                return true;
-        }
-
-int static EraseOrphanTx(uint256 hash)
-
-EXCLUSIVE_LOCKS_REQUIRED(g_cs_orphans)
-        {
-                std::map<uint256, COrphanTx>::iterator it = mapOrphanTransactions.find(hash);
-        if (it == mapOrphanTransactions.end())
-        return 0;
-        for (const CTxIn& txin : it->second.tx->vin)
-        {
-            auto itPrev = mapOrphanTransactionsByPrev.find(txin.prevout);
-            if (itPrev == mapOrphanTransactionsByPrev.end())
-                continue;
-            itPrev->second.erase(it);
-            if (itPrev->second.empty())
-                mapOrphanTransactionsByPrev.erase(itPrev);
-        }
-        assert(nMapOrphanTransactionsSize >= it->second.nTxSize);
-        nMapOrphanTransactionsSize -= it->second.nTxSize;
-        mapOrphanTransactions.erase(it);
-        statsClient.inc("transactions.orphans.remove", 1.0f);
-        statsClient.gauge("transactions.orphans", mapOrphanTransactions.size());
-        return 1;
-        }
-
-void EraseOrphansFor(NodeId peer) {
-    LOCK(g_cs_orphans);
-    int nErased = 0;
-    std::map<uint256, COrphanTx>::iterator iter = mapOrphanTransactions.begin();
-    while (iter != mapOrphanTransactions.end()) {
-        std::map<uint256, COrphanTx>::iterator maybeErase = iter++; // increment to avoid iterator becoming invalid
-        if (maybeErase->second.fromPeer == peer) {
-            nErased += EraseOrphanTx(maybeErase->second.tx->GetHash());
-        }
-    }
-    if (nErased > 0) LogPrint(BCLog::MEMPOOL, "Erased %d orphan tx from peer=%d\n", nErased, peer);
-}
-
-
-unsigned int LimitOrphanTxSize(unsigned int nMaxOrphansSize) {
-    LOCK(g_cs_orphans);
-
-    unsigned int nEvicted = 0;
-    static int64_t nNextSweep;
-    int64_t nNow = GetTime();
-    if (nNextSweep <= nNow) {
-        // Sweep out expired orphan pool entries:
-        int nErased = 0;
-        int64_t nMinExpTime = nNow + ORPHAN_TX_EXPIRE_TIME - ORPHAN_TX_EXPIRE_INTERVAL;
-        std::map<uint256, COrphanTx>::iterator iter = mapOrphanTransactions.begin();
-        while (iter != mapOrphanTransactions.end()) {
-            std::map<uint256, COrphanTx>::iterator maybeErase = iter++;
-            if (maybeErase->second.nTimeExpire <= nNow) {
-                nErased += EraseOrphanTx(maybeErase->second.tx->GetHash());
-            } else {
-                nMinExpTime = std::min(maybeErase->second.nTimeExpire, nMinExpTime);
-            }
-        }
-        // Sweep again 5 minutes after the next entry that expires in order to batch the linear scan.
-        nNextSweep = nMinExpTime + ORPHAN_TX_EXPIRE_INTERVAL;
-        if (nErased > 0) LogPrint(BCLog::MEMPOOL, "Erased %d orphan tx due to expiration\n", nErased);
-    }
-    FastRandomContext rng;
-    while (!mapOrphanTransactions.empty() && nMapOrphanTransactionsSize > nMaxOrphansSize) {
-        // Evict a random orphan:
-        uint256 randomhash = GetRandHash();
-        std::map<uint256, COrphanTx>::iterator it = mapOrphanTransactions.lower_bound(randomhash);
-        if (it == mapOrphanTransactions.end())
-            it = mapOrphanTransactions.begin();
-        EraseOrphanTx(it->first);
-        ++nEvicted;
-    }
-    return nEvicted;
-}
-
 void static ProcessOrphanTx(CConnman *connman, CTxMemPool &mempool, std::set <uint256> &orphan_work_set)
 
 EXCLUSIVE_LOCKS_REQUIRED(cs_main, g_cs_orphans
@@ -1239,48 +1108,20 @@ PeerLogicValidation::PeerLogicValidation(CConnman *connmanIn, BanMan *banman, CS
 }
 
 /**
- * Evict orphan txn pool entries (EraseOrphanTx) based on a newly connected
+ * Evict orphan txn pool entries based on a newly connected
  * block. Also save the time of the last tip update.
  */
 void PeerLogicValidation::BlockConnected(const std::shared_ptr<const CBlock> &pblock, const CBlockIndex *pindex,
                                          const std::vector <CTransactionRef> &vtxConflicted) {
     LOCK2(cs_main, g_cs_orphans);
 
-    std::vector <uint256> vOrphanErase;
+    // Which orphan pool entries we should reprocess and potentially try to accept into mempool again?
     std::set <uint256> orphanWorkSet;
-
     for (const CTransactionRef &ptx: pblock->vtx) {
-        const CTransaction &tx = *ptx;
-
-        // Which orphan pool entries we should reprocess and potentially try to accept into mempool again?
-        for (size_t i = 0; i < tx.vin.size(); i++) {
-            auto itByPrev = mapOrphanTransactionsByPrev.find(COutPoint(tx.GetHash(), (uint32_t) i));
-            if (itByPrev == mapOrphanTransactionsByPrev.end()) continue;
-            for (const auto &elem: itByPrev->second) {
-                orphanWorkSet.insert(elem->first);
-            }
-        }
-
-        // Which orphan pool entries must we evict?
-        for (const auto &txin: tx.vin) {
-            auto itByPrev = mapOrphanTransactionsByPrev.find(txin.prevout);
-            if (itByPrev == mapOrphanTransactionsByPrev.end()) continue;
-            for (auto mi = itByPrev->second.begin(); mi != itByPrev->second.end(); ++mi) {
-                const CTransaction &orphanTx = *(*mi)->second.tx;
-                const uint256 &orphanHash = orphanTx.GetHash();
-                vOrphanErase.push_back(orphanHash);
-            }
-        }
+        g_orphanage.AddChildrenToWorkSet(*ptx, orphanWorkSet);
     }
 
-    // Erase orphan transactions included or precluded by this block
-    if (vOrphanErase.size()) {
-        int nErased = 0;
-        for (const uint256 &orphanHash: vOrphanErase) {
-            nErased += EraseOrphanTx(orphanHash);
-        }
-        LogPrint(BCLog::MEMPOOL, "Erased %d orphan tx included or conflicted by block\n", nErased);
-    }
+    g_orphanage.EraseForBlock(*pblock);
 
     while (!orphanWorkSet.empty()) {
         LogPrint(BCLog::MEMPOOL, "Trying to process %d orphans\n", orphanWorkSet.size());
@@ -1299,6 +1140,53 @@ GUARDED_BY(cs_most_recent_block);
 static uint256 most_recent_block_hash
 GUARDED_BY(cs_most_recent_block);
 
+/** Recently served raw blocks kept in memory, peers doing IBD from us tend to request the same ranges */
+static constexpr size_t MAX_RAW_BLOCK_CACHE_SIZE = 16;
+static constexpr size_t MAX_RAW_BLOCK_CACHE_BYTES = 32 * 1024 * 1024;
+
+// Blocks as serialized on disk, most recently used first. They are shared with the send buffers of the peers
+// they were sent to, so evicting one only frees it once it was sent
+static Mutex cs_raw_block_cache;
+static std::list<std::pair<uint256, std::shared_ptr<const std::vector<uint8_t>>>> raw_block_cache
+GUARDED_BY(cs_raw_block_cache);
+static size_t raw_block_cache_bytes GUARDED_BY(cs_raw_block_cache) = 0;
+
+static std::shared_ptr<const std::vector<uint8_t>> GetRawBlock(const CBlockIndex *pindex, const CChainParams &chainparams) {
+    const uint256 &hash = pindex->GetBlockHash();
+    {
+        LOCK(cs_raw_block_cache);
+        for (auto it = raw_block_cache.begin(); it != raw_block_cache.end(); ++it) {
+            if (it->first == hash) {
+                raw_block_cache.splice(raw_block_cache.begin(), raw_block_cache, it);
+                return it->second;
+            }
+        }
+    }
+
+    auto block = std::make_shared<std::vector<uint8_t>>();
+    if (!ReadRawBlockFromDisk(*block, pindex, chainparams.MessageStart())) {
+        return nullptr;
+    }
+    std::shared_ptr<const std::vector<uint8_t>> ret = std::move(block);
+
+    LOCK(cs_raw_block_cache);
+    // Another thread may have read it in the meantime
+    for (const auto &entry: raw_block_cache) {
+        if (entry.first == hash) {
+            return entry.second;
+        }
+    }
+    raw_block_cache.emplace_front(hash, ret);
+    raw_block_cache_bytes += ret->size();
+    // Always keep the block just read, even if it's larger than the limit on its own
+    while (raw_block_cache.size() > 1 &&
+           (raw_block_cache.size() > MAX_RAW_BLOCK_CACHE_SIZE || raw_block_cache_bytes > MAX_RAW_BLOCK_CACHE_BYTES)) {
+        raw_block_cache_bytes -= raw_block_cache.back().second->size();
+        raw_block_cache.pop_back();
+    }
+    return ret;
+}
+
 /**
  * Maintain state about the best-seen block and fast-announce a compact block
  * to compatible peers.
@@ -1450,7 +1338,7 @@ EXCLUSIVE_LOCKS_REQUIRED(cs_main)
 
                         {
                             LOCK(g_cs_orphans);
-                            if (mapOrphanTransactions.count(inv.hash)) return true;
+                            if (g_orphanage.HaveTx(inv.hash)) return true;
                         }
                         const CCoinsViewCache &coins_cache = ::ChainstateActive().CoinsTip();
 
@@ -1638,9 +1526,24 @@ void static ProcessGetBlockData(CNode *pfrom, const CChainParams &chainparams, c
     // Pruned nodes may have deleted the block, so check whether
     // it's available before trying to send.
     if (send && (pindex->nStatus & BLOCK_HAVE_DATA)) {
+        // If a peer is asking for old blocks, we're almost guaranteed
+        // they won't have a useful mempool to match against a compact block,
+        // and we don't feel like constructing the object for them, so
+        // instead we respond with the full, non-compact block.
+        const bool fSendCompact = inv.type == MSG_CMPCT_BLOCK && CanDirectFetch(consensusParams) &&
+                                  pindex->nHeight >= ::ChainActive().Height() - MAX_CMPCTBLOCK_DEPTH;
         std::shared_ptr<const CBlock> pblock;
         if (a_recent_block && a_recent_block->GetHash() == pindex->GetBlockHash()) {
             pblock = a_recent_block;
+        } else if (inv.type == MSG_BLOCK || (inv.type == MSG_CMPCT_BLOCK && !fSendCompact)) {
+            // Full blocks are sent exactly as stored on disk, no need to deserialize and serialize them again
+            auto rawBlock = GetRawBlock(pindex, chainparams);
+            if (!rawBlock)
+                assert(!"cannot load block from disk");
+            CSerializedNetMsg msg;
+            msg.command = NetMsgType::BLOCK;
+            msg.shared_data = std::move(rawBlock);
+            connman->PushMessage(pfrom, std::move(msg));
         } else {
             // Send block from disk
             std::shared_ptr <CBlock> pblockRead = std::make_shared<CBlock>();
@@ -1683,12 +1586,7 @@ void static ProcessGetBlockData(CNode *pfrom, const CChainParams &chainparams, c
                 // else
                 // no response
             } else if (inv.type == MSG_CMPCT_BLOCK) {
-                // If a peer is asking for old blocks, we're almost guaranteed
-                // they won't have a useful mempool to match against a compact block,
-                // and we don't feel like constructing the object for them, so
-                // instead we respond with the full, non-compact block.
-                if (CanDirectFetch(consensusParams) &&
-                    pindex->nHeight >= ::ChainActive().Height() - MAX_CMPCTBLOCK_DEPTH) {
+                if (fSendCompact) {
                     if (a_recent_compact_block &&
                         a_recent_compact_block->header.GetHash() == pindex->GetBlockHash()) {
                         connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::CMPCTBLOCK, *a_recent_compact_block));
@@ -2180,16 +2078,11 @@ begin()
 
 );
 
-auto orphan_it = mapOrphanTransactions.find(orphanHash);
-if (orphan_it == mapOrphanTransactions.
-
-end()
-
-) continue;
+NodeId fromPeer = -1;
+const CTransactionRef porphanTx = g_orphanage.GetTx(orphanHash, fromPeer);
+if (!porphanTx) continue;
 
-const CTransactionRef porphanTx = orphan_it->second.tx;
 const CTransaction &orphanTx = *porphanTx;
-NodeId fromPeer = orphan_it->second.fromPeer;
 bool fMissingInputs2 = false;
 // Use a dummy CValidationState so someone can't setup nodes to counter-DoS based on orphan
 // resolution (that is, feeding people an invalid transaction based on LegitTxX in order to get
@@ -2214,29 +2107,8 @@ RelayTransaction(orphanTx
 GetHash(), *connman
 
 );
-for (
-unsigned int i = 0;
-i<orphanTx.vout.
-
-size();
-
-i++) {
-auto it_by_prev = mapOrphanTransactionsByPrev.find(COutPoint(orphanHash, i));
-if (it_by_prev != mapOrphanTransactionsByPrev.
-
-end()
-
-) {
-for (
-const auto &elem
-: it_by_prev->second) {
-orphan_work_set.
-insert(elem
-->first);
-}
-}
-}
-EraseOrphanTx(orphanHash);
+g_orphanage.AddChildrenToWorkSet(orphanTx, orphan_work_set);
+g_orphanage.EraseTx(orphanHash);
 done = true;
 } else if (!fMissingInputs2) {
 int nDos = 0;
@@ -2272,7 +2144,7 @@ assert(recentRejects);
 recentRejects->
 insert(orphanHash);
 }
-EraseOrphanTx(orphanHash);
+g_orphanage.EraseTx(orphanHash);
 done = true;
 }
 mempool.
@@ -2305,6 +2177,206 @@ std::string RejectCodeToString(const unsigned char code) {
     return "";
 }
 
+/**
+ * Validation logic for compact filters request handling.
+ *
+ * May disconnect from the peer in the case of a bad request.
+ *
+ * @param[in]   pfrom           The peer that we received the request from
+ * @param[in]   chainparams     Chain parameters
+ * @param[in]   filter_type     The filter type the request is for. Must be basic filters.
+ * @param[in]   start_height    The start height for the request
+ * @param[in]   stop_hash       The stop_hash for the request
+ * @param[in]   max_height_diff The maximum number of items permitted to request, as specified in BIP 157
+ * @param[out]  stop_index      The CBlockIndex for the stop_hash block, if the request can be serviced.
+ * @param[out]  filter_index    The filter index, if the request can be serviced.
+ * @return                      True if the request can be serviced.
+ */
+static bool PrepareBlockFilterRequest(CNode *pfrom, const CChainParams &chainparams,
+                                      BlockFilterType filter_type, uint32_t start_height,
+                                      const uint256 &stop_hash, uint32_t max_height_diff,
+                                      const CBlockIndex *&stop_index,
+                                      BlockFilterIndex *&filter_index) {
+    const bool supported_filter_type =
+            (filter_type == BlockFilterType::BASIC_FILTER &&
+             (pfrom->GetLocalServices() & NODE_COMPACT_FILTERS));
+    if (!supported_filter_type) {
+        LogPrint(BCLog::NET, "peer %d requested unsupported block filter type: %d\n",
+                 pfrom->GetId(), static_cast<uint8_t>(filter_type));
+        pfrom->fDisconnect = true;
+        return false;
+    }
+
+    {
+        LOCK(cs_main);
+        stop_index = LookupBlockIndex(stop_hash);
+
+        // Check that the stop block exists and the peer would be allowed to fetch it.
+        if (!stop_index || !BlockRequestAllowed(stop_index, chainparams.GetConsensus())) {
+            LogPrint(BCLog::NET, "peer %d requested invalid block hash: %s\n",
+                     pfrom->GetId(), stop_hash.ToString());
+            pfrom->fDisconnect = true;
+            return false;
+        }
+    }
+
+    uint32_t stop_height = stop_index->nHeight;
+    if (start_height > stop_height) {
+        LogPrint(BCLog::NET, "peer %d sent invalid getcfilters/getcfheaders with " /* Continued */
+                             "start height %d and stop height %d\n",
+                 pfrom->GetId(), start_height, stop_height);
+        pfrom->fDisconnect = true;
+        return false;
+    }
+    if (stop_height - start_height >= max_height_diff) {
+        LogPrint(BCLog::NET, "peer %d requested too many cfilters/cfheaders: %d / %d\n",
+                 pfrom->GetId(), stop_height - start_height + 1, max_height_diff);
+        pfrom->fDisconnect = true;
+        return false;
+    }
+
+    filter_index = GetBlockFilterIndex(filter_type);
+    if (!filter_index) {
+        LogPrint(BCLog::NET, "Filter index for supported type %s not found\n", BlockFilterTypeName(filter_type));
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Handle a cfilters request.
+ *
+ * May disconnect from the peer in the case of a bad request.
+ *
+ * @param[in]   pfrom           The peer that we received the request from
+ * @param[in]   vRecv           The raw message received
+ * @param[in]   chainparams     Chain parameters
+ * @param[in]   connman         Pointer to the connection manager
+ */
+static void ProcessGetCFilters(CNode *pfrom, CDataStream &vRecv, const CChainParams &chainparams,
+                               CConnman *connman) {
+    uint8_t filter_type_ser;
+    uint32_t start_height;
+    uint256 stop_hash;
+
+    vRecv >> filter_type_ser >> start_height >> stop_hash;
+
+    const BlockFilterType filter_type = static_cast<BlockFilterType>(filter_type_ser);
+
+    const CBlockIndex *stop_index;
+    BlockFilterIndex *filter_index;
+    if (!PrepareBlockFilterRequest(pfrom, chainparams, filter_type, start_height, stop_hash,
+                                   MAX_GETCFILTERS_SIZE, stop_index, filter_index)) {
+        return;
+    }
+
+    std::vector <BlockFilter> filters;
+    if (!filter_index->LookupFilterRange(start_height, stop_index, filters)) {
+        LogPrint(BCLog::NET, "Failed to find block filter in index: filter_type=%s, start_height=%d, stop_hash=%s\n",
+                 BlockFilterTypeName(filter_type), start_height, stop_hash.ToString());
+        return;
+    }
+
+    const CNetMsgMaker msgMaker(pfrom->GetSendVersion());
+    for (const auto &filter: filters) {
+        connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::CFILTER, filter));
+    }
+}
+
+/**
+ * Handle a cfheaders request.
+ *
+ * May disconnect from the peer in the case of a bad request.
+ *
+ * @param[in]   pfrom           The peer that we received the request from
+ * @param[in]   vRecv           The raw message received
+ * @param[in]   chainparams     Chain parameters
+ * @param[in]   connman         Pointer to the connection manager
+ */
+static void ProcessGetCFHeaders(CNode *pfrom, CDataStream &vRecv, const CChainParams &chainparams,
+                                CConnman *connman) {
+    uint8_t filter_type_ser;
+    uint32_t start_height;
+    uint256 stop_hash;
+
+    vRecv >> filter_type_ser >> start_height >> stop_hash;
+
+    const BlockFilterType filter_type = static_cast<BlockFilterType>(filter_type_ser);
+
+    const CBlockIndex *stop_index;
+    BlockFilterIndex *filter_index;
+    if (!PrepareBlockFilterRequest(pfrom, chainparams, filter_type, start_height, stop_hash,
+                                   MAX_GETCFHEADERS_SIZE, stop_index, filter_index)) {
+        return;
+    }
+
+    uint256 prev_header;
+    if (start_height > 0) {
+        const CBlockIndex *const prev_block =
+                stop_index->GetAncestor(static_cast<int>(start_height - 1));
+        if (!filter_index->LookupFilterHeader(prev_block, prev_header)) {
+            LogPrint(BCLog::NET, "Failed to find block filter header in index: filter_type=%s, block_hash=%s\n",
+                     BlockFilterTypeName(filter_type), prev_block->GetBlockHash().ToString());
+            return;
+        }
+    }
+
+    std::vector <uint256> filter_hashes;
+    if (!filter_index->LookupFilterHashRange(start_height, stop_index, filter_hashes)) {
+        LogPrint(BCLog::NET, "Failed to find block filter hashes in index: filter_type=%s, start_height=%d, stop_hash=%s\n",
+                 BlockFilterTypeName(filter_type), start_height, stop_hash.ToString());
+        return;
+    }
+
+    connman->PushMessage(pfrom, CNetMsgMaker(pfrom->GetSendVersion()).Make(NetMsgType::CFHEADERS,
+                                                                           filter_type_ser,
+                                                                           stop_index->GetBlockHash(),
+                                                                           prev_header,
+                                                                           filter_hashes));
+}
+
+/**
+ * Handle a getcfcheckpt request.
+ *
+ * May disconnect from the peer in the case of a bad request.
+ *
+ * @param[in]   pfrom           The peer that we received the request from
+ * @param[in]   vRecv           The raw message received
+ * @param[in]   chainparams     Chain parameters
+ * @param[in]   connman         Pointer to the connection manager
+ */
+static void ProcessGetCFCheckPt(CNode *pfrom, CDataStream &vRecv, const CChainParams &chainparams,
+                                CConnman *connman) {
+    uint8_t filter_type_ser;
+    uint256 stop_hash;
+
+    vRecv >> filter_type_ser >> stop_hash;
+
+    const BlockFilterType filter_type = static_cast<BlockFilterType>(filter_type_ser);
+
+    const CBlockIndex *stop_index;
+    BlockFilterIndex *filter_index;
+    if (!PrepareBlockFilterRequest(pfrom, chainparams, filter_type, /*start_height=*/0, stop_hash,
+                                   /*max_height_diff=*/std::numeric_limits<uint32_t>::max(),
+                                   stop_index, filter_index)) {
+        return;
+    }
+
+    // Served from the checkpoints cached by the index, only new checkpoints touch the database
+    std::vector <uint256> headers;
+    if (!filter_index->LookupFilterCheckpoints(stop_index, headers)) {
+        LogPrint(BCLog::NET, "Failed to find block filter checkpoints in index: filter_type=%s, stop_hash=%s\n",
+                 BlockFilterTypeName(filter_type), stop_hash.ToString());
+        return;
+    }
+
+    connman->PushMessage(pfrom, CNetMsgMaker(pfrom->GetSendVersion()).Make(NetMsgType::CFCHECKPT,
+                                                                           filter_type_ser,
+                                                                           stop_index->GetBlockHash(),
+                                                                           headers));
+}
+
 bool static ProcessMessage(CNode *pfrom, const std::string &strCommand, CDataStream &vRecv, int64_t nTimeReceived,
                            const CChainParams &chainparams, ChainstateManager &chainman, CTxMemPool &mempool,
                            CConnman *connman, BanMan *banman, const std::atomic<bool> &interruptMsgProc,
@@ -3169,14 +3241,9 @@ bool static ProcessMessage(CNode *pfrom, const std::string &strCommand, CDataStr
             mempool.check(&::ChainstateActive().CoinsTip());
             RelayTransaction(tx.GetHash(), *connman);
 
-            for (unsigned int i = 0; i < tx.vout.size(); i++) {
-                auto it_by_prev = mapOrphanTransactionsByPrev.find(COutPoint(inv.hash, i));
-                if (it_by_prev != mapOrphanTransactionsByPrev.end()) {
-                    for (const auto &elem: it_by_prev->second) {
-                        pfrom->orphan_work_set.insert(elem->first);
-                    }
-                }
-            }
+            // Orphans depending on this one are queued and processed one at a time by ProcessMessages, so that
+            // a long chain of orphans doesn't stall message handling for everyone else
+            g_orphanage.AddChildrenToWorkSet(tx, pfrom->orphan_work_set);
 
             pfrom->nLastTXTime = GetTime();
 
@@ -3184,9 +3251,6 @@ bool static ProcessMessage(CNode *pfrom, const std::string &strCommand, CDataStr
                      pfrom->GetId(),
                      tx.GetHash().ToString(),
                      mempool.size(), mempool.DynamicMemoryUsage() / 1000);
-
-            // Recursively process any orphan transactions that depended on this one
-            ProcessOrphanTx(connman, mempool, pfrom->orphan_work_set);
         } else if (fMissingInputs) {
             bool fRejectedParents = false; // It may be the case that the orphans parents have all been rejected
             for (const CTxIn &txin: tx.vin) {
@@ -3207,14 +3271,18 @@ bool static ProcessMessage(CNode *pfrom, const std::string &strCommand, CDataStr
                     pfrom->AddInventoryKnown(_inv2);
                     if (!AlreadyHave(_inv2, mempool)) RequestObject(State(pfrom->GetId()), _inv2, current_time);
                 }
-                AddOrphanTx(ptx, pfrom->GetId());
+                if (g_orphanage.AddTx(ptx, pfrom->GetId())) {
+                    AddToCompactExtraTransactions(ptx);
+                }
 
-                // DoS prevention: do not allow mapOrphanTransactions to grow unbounded
-                unsigned int nMaxOrphanTxSize = (unsigned int) std::max((int64_t)
+                // DoS prevention: do not allow the orphanage to grow unbounded
+                size_t nMaxOrphanTxSize = (size_t) std::max((int64_t)
                 0, gArgs.GetArg("-maxorphantxsize", DEFAULT_MAX_ORPHAN_TRANSACTIONS_SIZE)) *1000000;
-                unsigned int nEvicted = LimitOrphanTxSize(nMaxOrphanTxSize);
+                size_t nMaxOrphanTxSizePerPeer = (size_t) std::max((int64_t)
+                0, gArgs.GetArg("-maxorphantxsizeperpeer", DEFAULT_MAX_ORPHAN_TRANSACTIONS_SIZE_PER_PEER)) *1000000;
+                unsigned int nEvicted = g_orphanage.LimitOrphans(nMaxOrphanTxSize, nMaxOrphanTxSizePerPeer);
                 if (nEvicted > 0) {
-                    LogPrint(BCLog::MEMPOOL, "mapOrphan overflow, removed %u tx\n", nEvicted);
+                    LogPrint(BCLog::MEMPOOL, "orphanage overflow, removed %u tx\n", nEvicted);
                 }
             } else {
                 LogPrint(BCLog::MEMPOOL, "not keeping orphan with rejected parents %s\n", tx.GetHash().ToString());
@@ -3646,7 +3714,7 @@ bool static ProcessMessage(CNode *pfrom, const std::string &strCommand, CDataStr
         }
         pfrom->fSentAddr = true;
 
-        pfrom->vAddrToSend.clear();
+        pfrom->ClearAddressesToSend();
         std::vector <CAddress> vAddr = connman->GetAddresses();
         FastRandomContext insecure_rand;
         for (const CAddress &addr: vAddr) {
@@ -3800,6 +3868,21 @@ bool static ProcessMessage(CNode *pfrom, const std::string &strCommand, CDataStr
     }
 
 
+    if (strCommand == NetMsgType::GETCFILTERS) {
+        ProcessGetCFilters(pfrom, vRecv, chainparams, connman);
+        return true;
+    }
+
+    if (strCommand == NetMsgType::GETCFHEADERS) {
+        ProcessGetCFHeaders(pfrom, vRecv, chainparams, connman);
+        return true;
+    }
+
+    if (strCommand == NetMsgType::GETCFCHECKPT) {
+        ProcessGetCFCheckPt(pfrom, vRecv, chainparams, connman);
+        return true;
+    }
+
     if (strCommand == NetMsgType::GETMNLISTDIFF) {
         CGetSimplifiedMNListDiff cmd;
         vRecv >> cmd;
@@ -3930,6 +4013,39 @@ EXCLUSIVE_LOCKS_REQUIRED(cs_main)
         return false;
         }
 
+/**
+ * With several message handler threads (-msghandthreads) the messages of different peers are processed concurrently.
+ * Most handlers were written for a single thread and rely on no other handler running, this lock keeps them serialized.
+ */
+static RecursiveMutex g_cs_serial_msgproc;
+
+/**
+ * Commands processed outside of g_cs_serial_msgproc. Their handlers only touch state of the peer itself and state
+ * behind locks of their own (taking cs_main where they need it), and they are the slow ones: serving data, compact
+ * filters and mnlistdiffs, governance sync and LLMQ signing sessions.
+ */
+static bool IsParallelCommand(const std::string &strCommand) {
+    static const std::set<std::string> setParallelCommands{
+            NetMsgType::GETDATA,
+            NetMsgType::GETMNLISTDIFF,
+            NetMsgType::GETCFILTERS,
+            NetMsgType::GETCFHEADERS,
+            NetMsgType::GETCFCHECKPT,
+            NetMsgType::PING,
+            NetMsgType::PONG,
+            NetMsgType::MNGOVERNANCESYNC,
+            NetMsgType::MNGOVERNANCEOBJECT,
+            NetMsgType::MNGOVERNANCEOBJECTVOTE,
+            NetMsgType::QSIGSESANN,
+            NetMsgType::QSIGSHARESINV,
+            NetMsgType::QGETSIGSHARES,
+            NetMsgType::QBSIGSHARES,
+            NetMsgType::QSIGSHARE,
+            NetMsgType::QSIGREC,
+    };
+    return setParallelCommands.count(strCommand) != 0;
+}
+
 bool PeerLogicValidation::ProcessMessages(CNode *pfrom, std::atomic<bool> &interruptMsgProc) {
     const CChainParams &chainparams = Params();
     //
@@ -3946,6 +4062,7 @@ bool PeerLogicValidation::ProcessMessages(CNode *pfrom, std::atomic<bool> &inter
         ProcessGetData(pfrom, chainparams, connman, m_mempool, interruptMsgProc);
 
     if (!pfrom->orphan_work_set.empty()) {
+        LOCK(g_cs_serial_msgproc);
         LOCK2(cs_main, g_cs_orphans);
         ProcessOrphanTx(connman, m_mempool, pfrom->orphan_work_set);
     }
@@ -4006,9 +4123,16 @@ bool PeerLogicValidation::ProcessMessages(CNode *pfrom, std::atomic<bool> &inter
         return fMoreWork;
     }
 
+    static auto &histQueueTime = metrics::GetRegistry().GetHistogram("net_message_queue_ms",
+                                                                      "Time received messages wait to be processed");
+    const int64_t nProcessStart = GetTimeMicros();
+    histQueueTime.Observe((nProcessStart - msg.nTime) / 1000.0);
+
     // Process message
     bool fRet = false;
     try {
+        DebugLock<RecursiveMutex> lockSerial(IsParallelCommand(strCommand) ? nullptr : &g_cs_serial_msgproc,
+                                             "g_cs_serial_msgproc", __FILE__, __LINE__);
         fRet = ProcessMessage(pfrom, strCommand, vRecv, msg.nTime, chainparams, m_chainman, m_mempool, connman,
                               m_banman, interruptMsgProc, m_enable_bip61);
         if (interruptMsgProc)
@@ -4042,6 +4166,8 @@ bool PeerLogicValidation::ProcessMessages(CNode *pfrom, std::atomic<bool> &inter
         PrintExceptionContinue(std::current_exception(), "ProcessMessages()");
     }
 
+    pfrom->AddProcessTime(strCommand, GetTimeMicros() - nProcessStart);
+
     if (!fRet) {
         LogPrint(BCLog::NET, "%s(%s, %u bytes) FAILED peer=%d\n", __func__, SanitizeString(strCommand), nMessageSize,
                  pfrom->GetId());
@@ -4284,25 +4410,14 @@ bool PeerLogicValidation::SendMessages(CNode *pto) {
         //
         if (pto->nNextAddrSend < nNow) {
             pto->nNextAddrSend = PoissonNextSend(nNow, AVG_ADDRESS_BROADCAST_INTERVAL);
-            std::vector <CAddress> vAddr;
-            vAddr.reserve(pto->vAddrToSend.size());
-            for (const CAddress &addr: pto->vAddrToSend) {
-                if (!pto->addrKnown.contains(addr.GetKey())) {
-                    pto->addrKnown.insert(addr.GetKey());
-                    vAddr.push_back(addr);
-                    // receiver rejects addr messages larger than 1000
-                    if (vAddr.size() >= 1000) {
-                        connman->PushMessage(pto, msgMaker.Make(NetMsgType::ADDR, vAddr));
-                        vAddr.clear();
-                    }
-                }
-            }
-            pto->vAddrToSend.clear();
-            if (!vAddr.empty())
+            // The addr handlers of other peers keep pushing addresses, possibly on other threads
+            const std::vector <CAddress> vAddrToSend = pto->TakeAddressesToSend();
+            // receiver rejects addr messages larger than 1000
+            for (size_t i = 0; i < vAddrToSend.size(); i += 1000) {
+                const std::vector <CAddress> vAddr(vAddrToSend.begin() + i,
+                                                   vAddrToSend.begin() + std::min(i + 1000, vAddrToSend.size()));
                 connman->PushMessage(pto, msgMaker.Make(NetMsgType::ADDR, vAddr));
-            // we only send the big addr message once
-            if (pto->vAddrToSend.capacity() > 40)
-                pto->vAddrToSend.shrink_to_fit();
+            }
         }
 
         // Start block sync
@@ -4829,9 +4944,8 @@ public:
 
     ~CNetProcessingCleanup() {
         // orphan transactions
-        mapOrphanTransactions.clear();
-        mapOrphanTransactionsByPrev.clear();
-        nMapOrphanTransactionsSize = 0;
+        LOCK(g_cs_orphans);
+        g_orphanage.Clear();
     }
 };
 
@@ -19,6 +19,8 @@ extern RecursiveMutex cs_main;
 
 /** Default for -maxorphantxsize, maximum size in megabytes the orphan map can grow before entries are removed */
 static const unsigned int DEFAULT_MAX_ORPHAN_TRANSACTIONS_SIZE = 10; // this allows around 100 TXs of max size (and many more of normal size)
+/** Default for -maxorphantxsizeperpeer, maximum size in megabytes of orphans a single peer can make us keep */
+static const unsigned int DEFAULT_MAX_ORPHAN_TRANSACTIONS_SIZE_PER_PEER = 1;
 /** Default number of orphan+recently-replaced txn to keep around for block reconstruction */
 static const unsigned int DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN = 100;
 /** Default for BIP61 (sending reject messages) */
@@ -0,0 +1,178 @@
+// Copyright (c) 2025 The 405Coin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockprefetch.h>
+
+#include <chain.h>
+#include <logging.h>
+#include <tinyformat.h>
+#include <util/system.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <limits>
+
+//! Upper bound for -blockprefetchthreads
+static const int MAX_BLOCK_PREFETCH_THREADS = 16;
+
+int GetBlockPrefetchThreads() {
+    const int64_t nThreads = gArgs.GetArg("-blockprefetchthreads", DEFAULT_BLOCK_PREFETCH_THREADS);
+    return (int) std::max<int64_t>(0, std::min<int64_t>(nThreads, MAX_BLOCK_PREFETCH_THREADS));
+}
+
+CBlockPrefetcher::CBlockPrefetcher(const std::vector<const CBlockIndex *> &vBlocksIn,
+                                   const Consensus::Params &consensusParamsIn, int nThreads)
+        : consensusParams(&consensusParamsIn), vBlocks(vBlocksIn),
+          nMaxAhead(std::max(1, nThreads) * BLOCK_PREFETCH_AHEAD_PER_THREAD), nEnd(vBlocksIn.size()) {
+    AssertLockHeld(cs_main);
+    vPos.reserve(vBlocks.size());
+    for (const CBlockIndex *pindex: vBlocks) {
+        vPos.push_back(pindex->GetBlockPos());
+    }
+
+    Start(nThreads);
+}
+
+CBlockPrefetcher::CBlockPrefetcher(std::function<bool(CBlock &block, FlatFilePos &pos)> sourceIn, int nThreads)
+        : source(std::move(sourceIn)), nMaxAhead(std::max(1, nThreads) * BLOCK_PREFETCH_AHEAD_PER_THREAD),
+          nEnd(std::numeric_limits<size_t>::max()) {
+    Start(nThreads);
+}
+
+CBlockPrefetcher::~CBlockPrefetcher() {
+    {
+        LOCK(cs);
+        fInterrupt = true;
+    }
+    cvClaim.notify_all();
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+}
+
+void CBlockPrefetcher::Start(int nThreads) {
+    for (int i = 0; i < nThreads; i++) {
+        threads.emplace_back(&TraceThread<std::function<void()>>, strprintf("blkread.%d", i),
+                             std::function<void()>(std::bind(&CBlockPrefetcher::ThreadRead, this)));
+    }
+}
+
+bool CBlockPrefetcher::Next(std::shared_ptr<const CBlock> &block, FlatFilePos &pos) {
+    if (threads.empty()) {
+        LOCK(cs);
+        if (nNextTake >= nEnd) {
+            return false;
+        }
+        std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
+        if (!ReadBlock(nNextTake, pblock, pos)) {
+            nEnd = nNextTake;
+            return false;
+        }
+        block = std::move(pblock);
+        nNextTake++;
+        return true;
+    }
+
+    WAIT_LOCK(cs, lock);
+    cvReady.wait(lock, [this]() EXCLUSIVE_LOCKS_REQUIRED(cs) {
+        return mapReady.count(nNextTake) || nNextTake >= nEnd;
+    });
+    auto it = mapReady.find(nNextTake);
+    if (it == mapReady.end()) {
+        return false;
+    }
+    block = std::move(it->second.block);
+    pos = it->second.pos;
+    mapReady.erase(it);
+    nNextTake++;
+    cvClaim.notify_one();
+    return true;
+}
+
+const CBlockIndex *CBlockPrefetcher::PeekIndex() const {
+    LOCK(cs);
+    return nNextTake < vBlocks.size() ? vBlocks[nNextTake] : nullptr;
+}
+
+void CBlockPrefetcher::HintBlocks(size_t nBegin, size_t nEndHint) const {
+    // Hint each run of blocks stored one after the other. A run ends at the start of the block following it, the size
+    // of the last block of the file isn't known
+    const auto fContinues = [this](size_t i) {
+        return i < vPos.size() && vPos[i].nFile == vPos[i - 1].nFile && vPos[i].nPos > vPos[i - 1].nPos;
+    };
+    for (size_t nRunStart = nBegin, i = nBegin + 1; i <= nEndHint; i++) {
+        if (i < nEndHint && fContinues(i)) continue;
+        const size_t nRunEnd = fContinues(i) ? i : i - 1;
+        if (nRunEnd > nRunStart) {
+            // The size of a block is stored in the 8 bytes before it
+            const FlatFilePos start(vPos[nRunStart].nFile, vPos[nRunStart].nPos - std::min(vPos[nRunStart].nPos, 8u));
+            BlockFileReadAhead(start, vPos[nRunEnd].nPos - start.nPos);
+        }
+        nRunStart = i;
+    }
+}
+
+bool CBlockPrefetcher::ReadBlock(size_t nIndex, std::shared_ptr<CBlock> &block, FlatFilePos &pos) {
+    if (source) {
+        try {
+            return source(*block, pos);
+        } catch (const std::exception &e) {
+            LogPrintf("%s: Error reading blocks: %s\n", __func__, e.what());
+            return false;
+        }
+    }
+    pos = vPos[nIndex];
+    if (!ReadBlockFromDisk(*block, pos, *consensusParams) || block->GetHash() != vBlocks[nIndex]->GetBlockHash()) {
+        block.reset();
+    }
+    return true;
+}
+
+void CBlockPrefetcher::ThreadRead() {
+    while (true) {
+        std::shared_ptr<CBlock> block = std::make_shared<CBlock>();
+        FlatFilePos pos;
+        size_t nIndex;
+        {
+            // Blocks of a source are claimed and read in the same order
+            LOCK(csSource);
+            {
+                WAIT_LOCK(cs, lock);
+                cvClaim.wait(lock, [this]() EXCLUSIVE_LOCKS_REQUIRED(cs) {
+                    return fInterrupt || nNextClaim >= nEnd || nNextClaim < nNextTake + nMaxAhead;
+                });
+                if (fInterrupt || nNextClaim >= nEnd) {
+                    return;
+                }
+                nIndex = nNextClaim++;
+            }
+            if (!source && nNextHint < vPos.size() && nNextHint < nIndex + BLOCK_PREFETCH_HINT_WINDOW / 2) {
+                const size_t nEndHint = std::min(vPos.size(), nIndex + BLOCK_PREFETCH_HINT_WINDOW);
+                HintBlocks(std::max(nNextHint, nIndex), nEndHint);
+                nNextHint = nEndHint;
+            }
+            if (source && !ReadBlock(nIndex, block, pos)) {
+                {
+                    LOCK(cs);
+                    nEnd = nIndex;
+                }
+                cvClaim.notify_all();
+                cvReady.notify_all();
+                return;
+            }
+        }
+
+        if (source) {
+            block->GetPOWHash();
+        } else {
+            ReadBlock(nIndex, block, pos);
+        }
+
+        {
+            LOCK(cs);
+            mapReady.emplace(nIndex, Entry{std::move(block), pos});
+        }
+        cvReady.notify_all();
+    }
+}
@@ -0,0 +1,109 @@
+// Copyright (c) 2025 The 405Coin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_BLOCKPREFETCH_H
+#define BITCOIN_NODE_BLOCKPREFETCH_H
+
+#include <flatfile.h>
+#include <primitives/block.h>
+#include <sync.h>
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class CBlockIndex;
+
+namespace Consensus {
+    struct Params;
+}
+
+//! Default for -blockprefetchthreads
+static const int DEFAULT_BLOCK_PREFETCH_THREADS = 4;
+//! Blocks read but not taken yet, per reader thread
+static const size_t BLOCK_PREFETCH_AHEAD_PER_THREAD = 4;
+//! Blocks already on disk read ahead at once when connecting or verifying them
+static const int BLOCK_PREFETCH_RANGE = 1024;
+//! Blocks hinted to the OS ahead of the reader threads, topped up once half of them were claimed
+static const size_t BLOCK_PREFETCH_HINT_WINDOW = 64;
+
+/** Reader threads set by -blockprefetchthreads, 0 if blocks aren't read ahead */
+int GetBlockPrefetchThreads();
+
+/**
+ * Reads blocks ahead of a consumer which takes them in order, so reading and deserializing a block and checking its
+ * proof of work overlap with processing the previous ones.
+ *
+ * Reader threads claim the next block in order. At most BLOCK_PREFETCH_AHEAD_PER_THREAD blocks per thread are claimed
+ * but not taken yet, which bounds the memory used. Blocks are either read from known positions of the block files,
+ * concurrently, or from a source which can only be read in order, like a bootstrap file. A source is called by one
+ * reader at a time, the readers then check the proof of work of its blocks concurrently, which fills the PoW cache
+ * used by validation. Without reader threads blocks are read by Next().
+ */
+class CBlockPrefetcher {
+public:
+    /**
+     * Reads these blocks from the block files, the ranges of the next BLOCK_PREFETCH_HINT_WINDOW blocks are hinted to
+     * the OS as the readers advance. Requires cs_main.
+     */
+    CBlockPrefetcher(const std::vector<const CBlockIndex *> &vBlocksIn, const Consensus::Params &consensusParamsIn,
+                     int nThreads);
+
+    /** Reads blocks from the source until it returns false */
+    CBlockPrefetcher(std::function<bool(CBlock &block, FlatFilePos &pos)> sourceIn, int nThreads);
+
+    ~CBlockPrefetcher();
+
+    /**
+     * Waits for the next block, returns false past the last one. block is null if it couldn't be read, or if it's not
+     * the expected block. pos is where it was read from.
+     */
+    bool Next(std::shared_ptr<const CBlock> &block, FlatFilePos &pos);
+
+    /** The block the next call to Next() returns when reading from the block files, nullptr past the last one */
+    const CBlockIndex *PeekIndex() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<const CBlock> block;
+        FlatFilePos pos;
+    };
+
+    const Consensus::Params *consensusParams{nullptr};
+    std::vector<const CBlockIndex *> vBlocks;
+    std::vector<FlatFilePos> vPos;
+    std::function<bool(CBlock &, FlatFilePos &)> source;
+    const size_t nMaxAhead;
+
+    //! Held while claiming a block and reading it from the source, taken before cs
+    Mutex csSource;
+    //! Blocks before this one were hinted to the OS already
+    size_t nNextHint GUARDED_BY(csSource){0};
+    mutable Mutex cs;
+    std::condition_variable cvClaim;
+    std::condition_variable cvReady;
+    size_t nNextClaim GUARDED_BY(cs){0};
+    size_t nNextTake GUARDED_BY(cs){0};
+    //! Number of blocks, only known once the source has ended
+    size_t nEnd GUARDED_BY(cs);
+    bool fInterrupt GUARDED_BY(cs){false};
+    std::map<size_t, Entry> mapReady GUARDED_BY(cs);
+
+    std::vector<std::thread> threads;
+
+    void Start(int nThreads);
+
+    /** Hints the block file ranges of the blocks in [nBegin, nEndHint) to the OS */
+    void HintBlocks(size_t nBegin, size_t nEndHint) const;
+
+    /** Reads a block, returns false past the end of the source. block is reset if it couldn't be read. */
+    bool ReadBlock(size_t nIndex, std::shared_ptr<CBlock> &block, FlatFilePos &pos);
+
+    void ThreadRead();
+};
+
+#endif // BITCOIN_NODE_BLOCKPREFETCH_H
@@ -6,6 +6,7 @@
 
 #include <banman.h>
 #include <interfaces/chain.h>
+#include <miner.h>
 #include <net.h>
 #include <net_processing.h>
 #include <scheduler.h>
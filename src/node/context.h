@@ -12,6 +12,8 @@
 
 class BanMan;
 
+class BlockTemplateBuilder;
+
 class CConnman;
 
 class CScheduler;
@@ -52,6 +54,7 @@ struct NodeContext {
     //! load or create wallets opened by the gui.
     interfaces::WalletClient *wallet_client{nullptr};
     std::unique_ptr <CScheduler> scheduler;
+    std::unique_ptr <BlockTemplateBuilder> template_builder;
     std::function<void()> rpc_interruption_point = [] {};
 
     //! Declare default constructor and destructor that are not inline, so code
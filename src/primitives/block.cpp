@@ -25,25 +25,34 @@ uint256 CBlockHeader::ComputeHash() const {
     return HashGR(BEGIN(nVersion), END(nNonce), hashPrevBlock);
 }
 
-uint256 CBlockHeader::GetPOWHash(bool readCache) const {
-    LOCK(cs_pow);
-    CPowCache &cache(CPowCache::Instance());
+uint256 CBlockHeader::ComputeHash(const GRSchedule &schedule) const {
+    return HashGR(BEGIN(nVersion), END(nNonce), schedule);
+}
 
+uint256 CBlockHeader::GetPOWHash(bool readCache) const {
     uint256 headerHash = GetHash();
     uint256 powHash;
     bool found = false;
-
-    if (readCache) {
-        found = cache.get(headerHash, powHash);
+    bool validate;
+    {
+        LOCK(cs_pow);
+        CPowCache &cache(CPowCache::Instance());
+        if (readCache) {
+            found = cache.get(headerHash, powHash);
+        }
+        validate = cache.IsValidate();
     }
 
-    if (!found || cache.IsValidate()) {
+    if (!found || validate) {
+        // Hashed without holding cs_pow, so blocks read on several threads are hashed concurrently
         uint256 powHash2 = ComputeHash();
         if (found && powHash2 != powHash) {
             LogPrintf("PowCache failure: headerHash: %s, from cache: %s, computed: %s, correcting\n",
                       headerHash.ToString(), powHash.ToString(), powHash2.ToString());
         }
         powHash = powHash2;
+        LOCK(cs_pow);
+        CPowCache &cache(CPowCache::Instance());
         cache.erase(headerHash); // If it exists, replace it
         cache.insert(headerHash, powHash2);
     }
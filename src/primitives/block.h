@@ -13,6 +13,8 @@
 #include <unordered_lru_cache.h>
 
 
+struct GRSchedule;
+
 /** Nodes collect new transactions into a block, hash them into a hash tree,
  * and scan through nonce values to make the block's hash satisfy proof-of-work
  * requirements.  When they solve the proof-of-work, they broadcast the block
@@ -57,6 +59,9 @@ public:
     /// Compute the POW hash using GhostRider algorithm
     uint256 ComputeHash() const;
 
+    /// Compute the POW hash with a schedule made for hashPrevBlock, to hash many headers of the same block
+    uint256 ComputeHash(const GRSchedule &schedule) const;
+
     /// Caching lookup/computation of POW hash using GhostRider algorithm
     uint256 GetPOWHash(bool readCache = true) const;
 
@@ -29,12 +29,30 @@ CPowCache &CPowCache::Instance() {
 void CPowCache::DoMaintenance() {
     LOCK(cs_pow);
     // If cache has grown enough, save it:
-    if (cacheMap.size() - nLoadedSize > nMaxLoadSize) {
+    if (!fLoading && cacheMap.size() - nLoadedSize > nMaxLoadSize) {
         CFlatDB <CPowCache> flatDb("powcache.dat", "powCache");
         flatDb.Dump(*this);
     }
 }
 
+void CPowCache::StartLoading() {
+    LOCK(cs_pow);
+    fLoading = true;
+}
+
+void CPowCache::FinishLoading(const CPowCache &loaded) {
+    LOCK(cs_pow);
+    int64_t nStart = GetTimeMillis();
+    for (const auto &entry: loaded.cacheMap) {
+        if (cacheMap.count(entry.first) == 0) {
+            insert(entry.first, entry.second.first);
+        }
+    }
+    nLoadedSize = cacheMap.size();
+    fLoading = false;
+    LogPrintf("PowCache: merged %d loaded elements  %dms\n", loaded.cacheMap.size(), GetTimeMillis() - nStart);
+}
+
 CPowCache::CPowCache(int maxSize, bool validate, int maxLoadSize)
         : unordered_lru_cache<uint256, uint256, std::hash < uint256>>
 
@@ -44,7 +62,8 @@ CPowCache::CPowCache(int maxSize, bool validate, int maxLoadSize)
 nVersion (CURRENT_VERSION)
 , nLoadedSize(0)
 , bValidate(validate)
-, nMaxLoadSize(maxLoadSize) {
+, nMaxLoadSize(maxLoadSize)
+, fLoading(false) {
     if (bValidate) LogPrintf("PowCache: Validation and auto correction enabled\n");
 }
 
@@ -24,6 +24,8 @@ int nVersion;
 int nLoadedSize;
 int nMaxLoadSize;
 bool bValidate;
+//! Set while powcache.dat is loaded in the background, nothing is dumped until it's merged. Guarded by cs_pow.
+bool fLoading;
 RecursiveMutex cs;
 
 public:
@@ -45,6 +47,12 @@ bool IsValidate() const { return bValidate; }
 
 void DoMaintenance();
 
+/** Holds back dumps until FinishLoading, the cache keeps working meanwhile */
+void StartLoading();
+
+/** Adds the entries of a cache loaded from disk which aren't cached yet */
+void FinishLoading(const CPowCache &loaded);
+
 std::string ToString() const;
 
 ADD_POWCACHE_METHOD
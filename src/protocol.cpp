@@ -42,6 +42,12 @@ namespace NetMsgType {
     const char *CMPCTBLOCK = "cmpctblock";
     const char *GETBLOCKTXN = "getblocktxn";
     const char *BLOCKTXN = "blocktxn";
+    const char *GETCFILTERS = "getcfilters";
+    const char *CFILTER = "cfilter";
+    const char *GETCFHEADERS = "getcfheaders";
+    const char *CFHEADERS = "cfheaders";
+    const char *GETCFCHECKPT = "getcfcheckpt";
+    const char *CFCHECKPT = "cfcheckpt";
 // 405Coin message types
     const char *LEGACYTXLOCKREQUEST = "ix";
     const char *SPORK = "spork";
@@ -111,6 +117,12 @@ const static std::string allNetMessageTypes[] = {
         NetMsgType::CMPCTBLOCK,
         NetMsgType::GETBLOCKTXN,
         NetMsgType::BLOCKTXN,
+        NetMsgType::GETCFILTERS,
+        NetMsgType::CFILTER,
+        NetMsgType::GETCFHEADERS,
+        NetMsgType::CFHEADERS,
+        NetMsgType::GETCFCHECKPT,
+        NetMsgType::CFCHECKPT,
         // 405Coin message types
         // NOTE: do NOT include non-implmented here, we want them to be "Unknown command" in ProcessMessage()
         NetMsgType::LEGACYTXLOCKREQUEST,
@@ -328,6 +340,8 @@ static std::string serviceFlagToStr(size_t bit) {
             return "BLOOM";
         case NODE_XTHIN:
             return "XTHIN";
+        case NODE_COMPACT_FILTERS:
+            return "COMPACT_FILTERS";
         case NODE_NETWORK_LIMITED:
             return "NETWORK_LIMITED";
             // Not using default, so we get wqrned when a case is missing
@@ -9,6 +9,7 @@
 
 #include <amount.h>
 #include <base58.h>
+#include <blockfilter.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <checkpoints.h>
@@ -20,6 +21,7 @@
 #include <hash.h>
 #include <consensus/validation.h>
 #include <key_io.h>
+#include <index/blockfilterindex.h>
 #include <index/txindex.h>
 #include <policy/policy.h>
 #include <primitives/transaction.h>
@@ -2783,6 +2785,199 @@ static UniValue scantxoutset(const JSONRPCRequest &request) {
     return result;
 }
 
+static UniValue getblockfilter(const JSONRPCRequest &request) {
+    RPCHelpMan{"getblockfilter",
+               "\nRetrieve a BIP 157 content filter for a particular block.\n",
+               {
+                       {"blockhash", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The hash of the block"},
+                       {"filtertype", RPCArg::Type::STR, /* default */ "basic", "The type name of the filter"},
+               },
+               RPCResult{
+                       RPCResult::Type::OBJ, "", "",
+                       {
+                               {RPCResult::Type::STR_HEX, "filter", "the hex-encoded filter data"},
+                               {RPCResult::Type::STR_HEX, "header", "the hex-encoded filter header"},
+                       }},
+               RPCExamples{
+                       HelpExampleCli("getblockfilter",
+                                      "\"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09\" \"basic\"")
+                       + HelpExampleRpc("getblockfilter",
+                                        "\"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09\", \"basic\"")
+               },
+    }.Check(request);
+
+    uint256 block_hash = ParseHashV(request.params[0], "blockhash");
+    std::string filtertype_name = "basic";
+    if (!request.params[1].isNull()) {
+        filtertype_name = request.params[1].get_str();
+    }
+
+    BlockFilterType filtertype;
+    if (!BlockFilterTypeByName(filtertype_name, filtertype)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown filtertype");
+    }
+
+    BlockFilterIndex *index = GetBlockFilterIndex(filtertype);
+    if (!index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Index is not enabled for filtertype " + filtertype_name);
+    }
+
+    const CBlockIndex *block_index;
+    bool block_was_connected;
+    {
+        LOCK(cs_main);
+        block_index = LookupBlockIndex(block_hash);
+        if (!block_index) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+        }
+        block_was_connected = block_index->IsValid(BLOCK_VALID_SCRIPTS);
+    }
+
+    bool index_ready = index->BlockUntilSyncedToCurrentChain();
+
+    BlockFilter filter;
+    uint256 filter_header;
+    if (!index->LookupFilter(block_index, filter) ||
+        !index->LookupFilterHeader(block_index, filter_header)) {
+        int err_code;
+        std::string errmsg = "Filter not found.";
+
+        if (!block_was_connected) {
+            err_code = RPC_INVALID_ADDRESS_OR_KEY;
+            errmsg += " Block was not connected to active chain.";
+        } else if (!index_ready) {
+            err_code = RPC_MISC_ERROR;
+            errmsg += " Block filters are still in the process of being indexed.";
+        } else {
+            err_code = RPC_INTERNAL_ERROR;
+            errmsg += " This error is unexpected and indicates index corruption.";
+        }
+
+        throw JSONRPCError(err_code, errmsg);
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("filter", HexStr(filter.GetEncodedFilter()));
+    ret.pushKV("header", filter_header.GetHex());
+    return ret;
+}
+
+static UniValue scanassetfilters(const JSONRPCRequest &request) {
+    RPCHelpMan{"scanassetfilters",
+               "\nFind the blocks whose asset filter matches any of the given assets, addresses or masternodes.\n"
+               "Requires -blockfilterindex=asset. Filters have false positives, the blocks found may not be relevant.\n",
+               {
+                       {"query", RPCArg::Type::OBJ, RPCArg::Optional::NO, "What to look for",
+                        {
+                                {"assets", RPCArg::Type::ARR, /* default */ "[]", "Asset ids, the txids of the transactions creating the assets, matching their creation, updates, mints and transfers",
+                                 {
+                                         {"assetid", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, ""},
+                                 },
+                                },
+                                {"addresses", RPCArg::Type::ARR, /* default */ "[]", "Addresses, matching payments, asset transfers, future locks and asset ownership",
+                                 {
+                                         {"address", RPCArg::Type::STR, RPCArg::Optional::OMITTED, ""},
+                                 },
+                                },
+                                {"protxhashes", RPCArg::Type::ARR, /* default */ "[]", "Masternode registrations, matching them and their updates",
+                                 {
+                                         {"protxhash", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, ""},
+                                 },
+                                },
+                        },
+                       },
+                       {"start_height", RPCArg::Type::NUM, /* default */ "0", "The height to start scanning from"},
+                       {"stop_height", RPCArg::Type::NUM, /* default */ "tip", "The height to stop scanning at"},
+               },
+               RPCResult{
+                       RPCResult::Type::ARR, "", "",
+                       {
+                               {RPCResult::Type::OBJ, "", "",
+                                {
+                                        {RPCResult::Type::NUM, "height", "The block height"},
+                                        {RPCResult::Type::STR_HEX, "blockhash", "The block hash"},
+                                }},
+                       }},
+               RPCExamples{
+                       HelpExampleCli("scanassetfilters", "'{\"assets\": [\"b683eccf3267561e1d5f5ad0caeb362b50d0d3a68e71cceee69869df173fed12\"]}' 1000")
+                       + HelpExampleRpc("scanassetfilters", "{\"assets\": [\"b683eccf3267561e1d5f5ad0caeb362b50d0d3a68e71cceee69869df173fed12\"]}, 1000")
+               },
+    }.Check(request);
+
+    BlockFilterIndex *index = GetBlockFilterIndex(BlockFilterType::ASSET_FILTER);
+    if (!index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Index is not enabled for filtertype asset");
+    }
+
+    RPCTypeCheckArgument(request.params[0], UniValue::VOBJ);
+    const UniValue &query = request.params[0].get_obj();
+    RPCTypeCheckObj(query,
+                    {
+                            {"assets", UniValueType(UniValue::VARR)},
+                            {"addresses", UniValueType(UniValue::VARR)},
+                            {"protxhashes", UniValueType(UniValue::VARR)},
+                    }, true, true);
+
+    const auto values = [&query](const std::string &key) {
+        const UniValue &value = find_value(query, key);
+        return value.isNull() ? std::vector<UniValue>() : value.getValues();
+    };
+
+    GCSFilter::ElementSet elements;
+    for (const UniValue &assetId: values("assets")) {
+        elements.insert(AssetFilterAssetIdElement(ParseHashV(assetId, "assetid").ToString()));
+    }
+    for (const UniValue &address: values("addresses")) {
+        CTxDestination dest = DecodeDestination(address.get_str());
+        if (!IsValidDestination(dest)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address: " + address.get_str());
+        }
+        const CScript script = GetScriptForDestination(dest);
+        elements.emplace(script.begin(), script.end());
+        elements.insert(AssetFilterFutureElement(script));
+    }
+    for (const UniValue &proTxHash: values("protxhashes")) {
+        elements.insert(AssetFilterProTxElement(ParseHashV(proTxHash, "protxhash")));
+    }
+    if (elements.empty()) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Nothing to scan for");
+    }
+
+    if (!index->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Block filters are still in the process of being indexed.");
+    }
+
+    const CBlockIndex *stop_index;
+    int start_height = request.params[1].isNull() ? 0 : request.params[1].get_int();
+    {
+        LOCK(cs_main);
+        int stop_height = request.params[2].isNull() ? ::ChainActive().Height() : request.params[2].get_int();
+        if (start_height < 0 || stop_height > ::ChainActive().Height() || start_height > stop_height) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid height range");
+        }
+        stop_index = ::ChainActive()[stop_height];
+    }
+
+    // Read the filters in batches, a range lookup reads each filter file once
+    static constexpr int SCAN_BATCH_SIZE = 1000;
+    UniValue ret(UniValue::VARR);
+    std::vector<BlockFilter> filters;
+    for (int height = start_height; height <= stop_index->nHeight; height += SCAN_BATCH_SIZE) {
+        const CBlockIndex *batch_stop = stop_index->GetAncestor(std::min(height + SCAN_BATCH_SIZE - 1, stop_index->nHeight));
+        if (!index->LookupFilterRange(height, batch_stop, filters)) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Filter not found. This error is unexpected and indicates index corruption.");
+        }
+        for (size_t i = 0; i < filters.size(); i++) {
+            if (!filters[i].GetFilter().MatchAny(elements)) continue;
+            UniValue entry(UniValue::VOBJ);
+            entry.pushKV("height", height + (int) i);
+            entry.pushKV("blockhash", filters[i].GetBlockHash().GetHex());
+            ret.push_back(entry);
+        }
+    }
+    return ret;
+}
+
 /**
  * Serialize the UTXO set to a file for loading elsewhere.
  *
@@ -2917,6 +3112,8 @@ static const CRPCCommand commands[] =
 
                 {"blockchain", "preciousblock",                    &preciousblock,                    {"blockhash"}},
                 {"blockchain", "scantxoutset",                     &scantxoutset,                     {"action",         "scanobjects"}},
+                {"blockchain", "getblockfilter",                   &getblockfilter,                   {"blockhash",      "filtertype"}},
+                {"blockchain", "scanassetfilters",                 &scanassetfilters,                 {"query",          "start_height", "stop_height"}},
 
                 /* Not shown in help */
                 {"hidden",     "invalidateblock",                  &invalidateblock,                  {"blockhash"}},
@@ -89,6 +89,9 @@ static const CRPCConvertParam vRPCConvertParams[] =
                 {"deriveaddresses", 1, "begin"},
                 {"deriveaddresses", 2, "end"},
                 {"scantxoutset", 1, "scanobjects"},
+                {"scanassetfilters", 0, "query"},
+                {"scanassetfilters", 1, "start_height"},
+                {"scanassetfilters", 2, "stop_height"},
                 {"addmultisigaddress", 0, "nrequired"},
                 {"addmultisigaddress", 1, "keys"},
                 {"createmultisig", 0, "nrequired"},
@@ -30,6 +30,13 @@
 #include <wallet/wallet.h>
 #endif // ENABLE_WALLET
 
+/** Objects and votes added while governance.dat is loaded in the background would be wiped by the load */
+static void EnsureGovernanceLoaded() {
+    if (!governance.IsLoaded()) {
+        throw JSONRPCError(RPC_IN_WARMUP, "Governance objects are still being loaded. Try again in a minute or so.");
+    }
+}
+
 void gobject_count_help(const JSONRPCRequest &request) {
     RPCHelpMan{"gobject count",
                "Count governance objects and votes\n",
@@ -313,6 +320,8 @@ static void gobject_submit_help(const JSONRPCRequest &request) {
 static UniValue gobject_submit(const JSONRPCRequest &request) {
     gobject_submit_help(request);
 
+    EnsureGovernanceLoaded();
+
     if (!smartnodeSync.IsBlockchainSynced()) {
         throw JSONRPCError(RPC_CLIENT_IN_INITIAL_DOWNLOAD,
                            "Must wait for client to sync with smartnode network. Try again in a minute or so.");
@@ -438,6 +447,8 @@ void gobject_vote_conf_help(const JSONRPCRequest &request) {
 static UniValue gobject_vote_conf(const JSONRPCRequest &request) {
     gobject_vote_conf_help(request);
 
+    EnsureGovernanceLoaded();
+
     uint256 hash;
 
     hash = ParseHashV(request.params[0], "Object hash");
@@ -538,6 +549,7 @@ UniValue VoteWithSmartnodes(const JSONRPCRequest &request, const std::map <uint2
                             const uint256 &hash, vote_signal_enum_t eVoteSignal,
                             vote_outcome_enum_t eVoteOutcome) {
     const NodeContext &node = EnsureNodeContext(request.context);
+    EnsureGovernanceLoaded();
     {
         LOCK(governance.cs);
         CGovernanceObject *pGovObj = governance.FindGovernanceObject(hash);
@@ -1078,6 +1090,8 @@ UniValue voteraw(const JSONRPCRequest &request) {
                RPCExamples{""}
     }.Check(request);
 
+    EnsureGovernanceLoaded();
+
     uint256 hashMnCollateralTx = ParseHashV(request.params[0], "mn collateral tx hash");
     int nMnCollateralTxIndex = request.params[1].get_int();
     COutPoint outpoint = COutPoint(hashMnCollateralTx, nMnCollateralTxIndex);
@@ -682,8 +682,10 @@ static UniValue getblocktemplate(const JSONRPCRequest &request) {
     static CBlockIndex *pindexPrev;
     static int64_t nStart;
     static std::unique_ptr <CBlockTemplate> pblocktemplate;
+    // Updating the template of the builder is cheap, it throttles full rebuilds itself
     if (pindexPrev != ::ChainActive().Tip() ||
-        (mempool.GetTransactionsUpdated() != nTransactionsUpdatedLast && GetTime() - nStart > 5)) {
+        (mempool.GetTransactionsUpdated() != nTransactionsUpdatedLast &&
+         (node.template_builder || GetTime() - nStart > 5))) {
         // Clear pindexPrev so future calls make a new block, despite any failures from here on
         pindexPrev = nullptr;
 
@@ -694,7 +696,11 @@ static UniValue getblocktemplate(const JSONRPCRequest &request) {
 
         // Create new block
         CScript scriptDummy = CScript() << OP_TRUE;
-        pblocktemplate = BlockAssembler(mempool, Params()).CreateNewBlock(scriptDummy);
+        if (node.template_builder) {
+            pblocktemplate = node.template_builder->GetTemplate(scriptDummy);
+        } else {
+            pblocktemplate = BlockAssembler(mempool, Params()).CreateNewBlock(scriptDummy);
+        }
         if (!pblocktemplate)
             throw JSONRPCError(RPC_OUT_OF_MEMORY, "Out of memory");
 
@@ -15,6 +15,7 @@
 #include <init.h>
 #include <interfaces/chain.h>
 #include <key_io.h>
+#include <metrics.h>
 #include <net.h>
 #include <netbase.h>
 #include <node/context.h>
@@ -1419,6 +1420,80 @@ UniValue getmemoryinfo(const JSONRPCRequest &request) {
     }
 }
 
+static UniValue getmetrics(const JSONRPCRequest &request) {
+    RPCHelpMan{"getmetrics",
+               "Returns the current value of the internal metrics.\n"
+               "Latency histograms are in milliseconds, quantiles are estimated from the buckets.\n"
+               "The same metrics can be scraped in the Prometheus text format from /metrics if -metrics is enabled.\n",
+               {},
+               RPCResult{
+                       RPCResult::Type::OBJ, "", "",
+                       {
+                               {RPCResult::Type::OBJ_DYN, "counters", "",
+                                {
+                                        {RPCResult::Type::NUM, "name", "Value of the counter"},
+                                }},
+                               {RPCResult::Type::OBJ_DYN, "gauges", "",
+                                {
+                                        {RPCResult::Type::NUM, "name", "Value of the gauge"},
+                                }},
+                               {RPCResult::Type::OBJ_DYN, "histograms", "",
+                                {
+                                        {RPCResult::Type::OBJ, "name", "",
+                                         {
+                                                 {RPCResult::Type::NUM, "count", "Number of observations"},
+                                                 {RPCResult::Type::NUM, "sum", "Sum of all observations"},
+                                                 {RPCResult::Type::NUM, "p50", "Estimated median"},
+                                                 {RPCResult::Type::NUM, "p90", "Estimated 90th percentile"},
+                                                 {RPCResult::Type::NUM, "p99", "Estimated 99th percentile"},
+                                                 {RPCResult::Type::OBJ_DYN, "buckets",
+                                                  "Non-cumulative number of observations up to each bound",
+                                                  {
+                                                          {RPCResult::Type::NUM, "bound", "Observations in the bucket"},
+                                                  }},
+                                         }},
+                                }},
+                       }},
+               RPCExamples{
+                       HelpExampleCli("getmetrics", "")
+                       + HelpExampleRpc("getmetrics", "")
+               },
+    }.Check(request);
+
+    const auto &registry = metrics::GetRegistry();
+    UniValue counters(UniValue::VOBJ);
+    registry.ForEachCounter([&](const std::string &name, const metrics::Counter &counter) {
+        counters.pushKV(name, counter.Get());
+    });
+    UniValue gauges(UniValue::VOBJ);
+    registry.ForEachGauge([&](const std::string &name, const metrics::Gauge &gauge) {
+        gauges.pushKV(name, gauge.Get());
+    });
+    UniValue histograms(UniValue::VOBJ);
+    registry.ForEachHistogram([&](const std::string &name, const metrics::Histogram &histogram) {
+        const auto snapshot = histogram.GetSnapshot();
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("count", snapshot.nCount);
+        obj.pushKV("sum", snapshot.sum);
+        obj.pushKV("p50", snapshot.Quantile(0.5));
+        obj.pushKV("p90", snapshot.Quantile(0.9));
+        obj.pushKV("p99", snapshot.Quantile(0.99));
+        UniValue buckets(UniValue::VOBJ);
+        for (size_t i = 0; i < snapshot.vCounts.size(); i++) {
+            buckets.pushKV(i < snapshot.vBounds.size() ? strprintf("%g", snapshot.vBounds[i]) : "+Inf",
+                           snapshot.vCounts[i]);
+        }
+        obj.pushKV("buckets", buckets);
+        histograms.pushKV(name, obj);
+    });
+
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("counters", counters);
+    result.pushKV("gauges", gauges);
+    result.pushKV("histograms", histograms);
+    return result;
+}
+
 void EnableOrDisableLogCategories(UniValue cats, bool enable) {
     cats = cats.get_array();
     for (unsigned int i = 0; i < cats.size(); ++i) {
@@ -1531,6 +1606,7 @@ static const CRPCCommand commands[] =
                 //  --------------------- ------------------------  -----------------------  ----------
                 {"control",      "getmemoryinfo",          &getmemoryinfo,          {"mode"}},
                 {"control",      "logging",                &logging,                {"include",    "exclude"}},
+                {"control",      "getmetrics",             &getmetrics,             {}},
                 {"util",         "validateaddress",        &validateaddress,        {"address"}},
                 {"util",         "createmultisig",         &createmultisig,         {"nrequired",  "keys"}},
                 {"util",         "deriveaddresses",        &deriveaddresses,        {"descriptor", "begin",     "end"}},
@@ -159,6 +159,14 @@ UniValue getpeerinfo(const JSONRPCRequest &request) {
                                                           "Only known message types can appear as keys in the object and all bytes received of unknown message types are listed under '" +
                                                           NET_MESSAGE_COMMAND_OTHER + "'."}
                                                  }},
+                                                {RPCResult::Type::OBJ, "processtime_per_msg", "",
+                                                 {
+                                                         {RPCResult::Type::NUM, "msg",
+                                                          "The total time in microseconds spent processing messages, aggregated by message type\n"
+                                                          "When a message type is not listed in this json object, no time was spent on it.\n"
+                                                          "Only known message types can appear as keys in the object and the time spent on unknown message types is listed under '" +
+                                                          NET_MESSAGE_COMMAND_OTHER + "'."}
+                                                 }},
                                         }},
                                }}},
                RPCExamples{
@@ -250,6 +258,13 @@ UniValue getpeerinfo(const JSONRPCRequest &request) {
         }
         obj.pushKV("bytesrecv_per_msg", recvPerMsgCmd);
 
+        UniValue processTimePerMsgCmd(UniValue::VOBJ);
+        for (const mapMsgCmdSize::value_type &i: stats.mapProcessTimePerMsgCmd) {
+            if (i.second > 0)
+                processTimePerMsgCmd.pushKV(i.first, i.second);
+        }
+        obj.pushKV("processtime_per_msg", processTimePerMsgCmd);
+
         ret.push_back(obj);
     }
 
@@ -527,6 +527,95 @@ UniValue quorum_selectquorum(const JSONRPCRequest &request) {
     return ret;
 }
 
+void quorum_recsigcache_help(const JSONRPCRequest &request) {
+    RPCHelpMan{"quorum recsigcache",
+               "Return statistics about the recovered signatures lookup caches\n",
+               {},
+               RPCResult{
+                       RPCResult::Type::OBJ, "", "",
+                       {
+                               {RPCResult::Type::NUM, "cacheHits", "Lookups answered by the in-memory caches"},
+                               {RPCResult::Type::NUM, "filterNegatives", "Negative lookups answered by the filters without touching the db"},
+                               {RPCResult::Type::NUM, "dbReads", "Lookups that had to read the db"},
+                               {RPCResult::Type::NUM, "falsePositives", "Db reads which turned out to be negative"},
+                               {RPCResult::Type::NUM, "filterRebuilds", "Number of times the filters were rebuilt from the db"},
+                               {RPCResult::Type::NUM, "filterElements", "Number of elements in all filters"},
+                               {RPCResult::Type::NUM, "filterCapacity", "Capacity of all filters"},
+                               {RPCResult::Type::NUM, "cacheEntries", "Number of entries in all caches"},
+                               {RPCResult::Type::NUM, "cacheMaxEntries", "Maximum number of entries in all caches (see -recsigcache)"},
+                               {RPCResult::Type::NUM, "memoryUsage", "Memory used by caches and filters in bytes"},
+                       }},
+               RPCExamples{
+                       HelpExampleCli("quorum", "recsigcache")
+                       + HelpExampleRpc("quorum", "recsigcache")
+               },
+    }.Check(request);
+}
+
+UniValue quorum_recsigcache(const JSONRPCRequest &request) {
+    quorum_recsigcache_help(request);
+
+    return llmq::quorumSigningManager->GetRecoveredSigsCacheStats().ToJson();
+}
+
+void quorum_sigsharestats_help(const JSONRPCRequest &request) {
+    RPCHelpMan{"quorum sigsharestats",
+               "Return memory usage of signing sessions, in total and per peer\n",
+               {
+                       {"detail_level", RPCArg::Type::NUM, /* default */ "0",
+                        "Detail level of output.\n"
+                        "0=Only show totals and per peer usage. 1=Also show per session usage."},
+               },
+               RPCResult{
+                       RPCResult::Type::OBJ, "", "",
+                       {
+                               {RPCResult::Type::NUM, "sessions", "Number of signing sessions with sig shares"},
+                               {RPCResult::Type::NUM, "sigShares", "Number of sig shares in all sessions"},
+                               {RPCResult::Type::NUM, "memoryUsage", "Memory used by all signing sessions in bytes"},
+                               {RPCResult::Type::NUM, "maxMemoryUsage", "Memory limit in bytes before the oldest sessions are shed (see -maxsigsharesmem)"},
+                               {RPCResult::Type::NUM, "timedOutSessions", "Number of sessions which timed out"},
+                               {RPCResult::Type::NUM, "shedSessions", "Number of sessions shed because of the memory limit"},
+                               {RPCResult::Type::ARR, "nodes", "Per peer usage",
+                                {
+                                        {RPCResult::Type::OBJ, "", "",
+                                         {
+                                                 {RPCResult::Type::NUM, "nodeId", "Peer id"},
+                                                 {RPCResult::Type::NUM, "sessions", "Number of sessions tracked for the peer"},
+                                                 {RPCResult::Type::NUM, "memoryUsage", "Memory used for the peer in bytes"},
+                                         }},
+                                }},
+                               {RPCResult::Type::ARR, "sessionsDetail", /* optional */ true, "Per session usage, only with detail_level 1",
+                                {
+                                        {RPCResult::Type::OBJ, "", "",
+                                         {
+                                                 {RPCResult::Type::STR_HEX, "signHash", "Sign hash of the session"},
+                                                 {RPCResult::Type::NUM, "sigShares", "Number of sig shares"},
+                                                 {RPCResult::Type::NUM, "lastSeenAge", "Seconds since a sig share was last seen"},
+                                                 {RPCResult::Type::NUM, "memoryUsage", "Memory used by the session in bytes"},
+                                         }},
+                                }},
+                       }},
+               RPCExamples{
+                       HelpExampleCli("quorum", "sigsharestats")
+                       + HelpExampleCli("quorum", "sigsharestats 1")
+               },
+    }.Check(request);
+}
+
+UniValue quorum_sigsharestats(const JSONRPCRequest &request) {
+    quorum_sigsharestats_help(request);
+
+    int detailLevel = 0;
+    if (!request.params[0].isNull()) {
+        detailLevel = ParseInt32V(request.params[0], "detail_level");
+        if (detailLevel < 0 || detailLevel > 1) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "invalid detail_level");
+        }
+    }
+
+    return llmq::quorumSigSharesManager->GetStats(detailLevel > 0).ToJson(detailLevel);
+}
+
 void quorum_dkgsimerror_help(const JSONRPCRequest &request) {
     RPCHelpMan{"quorum dkgsimerror",
                "This enables simulation of errors and malicious behaviour in the DKG. Do NOT use this on mainnet\n"
@@ -626,6 +715,8 @@ UniValue quorum_getdata(const JSONRPCRequest &request) {
                        "  getrecsig         - Get a recovered signature\n"
                        "  isconflicting     - Test if a conflict exists\n"
                        "  selectquorum      - Return the quorum that would/should sign a request\n"
+                       "  recsigcache       - Return statistics about the recovered signatures lookup caches\n"
+                       "  sigsharestats     - Return memory usage of signing sessions\n"
                        "  getdata           - Request quorum data from other smartnodes in the quorum\n",
                        {
                                {"command", RPCArg::Type::STR, RPCArg::Optional::NO, "command to execute"},
@@ -652,6 +743,10 @@ UniValue _quorum(const JSONRPCRequest &request) {
         return quorum_sigs_cmd(new_request);
     } else if (command == "quorumselectquorum") {
         return quorum_selectquorum(new_request);
+    } else if (command == "quorumrecsigcache") {
+        return quorum_recsigcache(new_request);
+    } else if (command == "quorumsigsharestats") {
+        return quorum_sigsharestats(new_request);
     } else if (command == "quorumdkgsimerror") {
         return quorum_dkgsimerror(new_request);
     } else if (command == "quorumgetdata") {
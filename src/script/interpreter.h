@@ -105,6 +105,8 @@ bool CheckSignatureEncoding(const std::vector<unsigned char> &vchSig, unsigned i
 struct PrecomputedTransactionData {
     uint256 hashPrevouts, hashSequence, hashOutputs;
 
+    PrecomputedTransactionData() = default;
+
     template<class T>
     explicit PrecomputedTransactionData(const T &tx);
 };
@@ -244,6 +244,12 @@ void CSmartnodeSync::ProcessTick(CConnman &connman) {
                     connman.ReleaseNodeVector(vNodesCopy);
                     return;
                 }
+                if (!governance.IsLoaded()) {
+                    // governance.dat is still being loaded, don't time out on peers whose objects we ignore
+                    BumpAssetLastTime("CSmartnodeSync::ProcessTick -- governance loading");
+                    connman.ReleaseNodeVector(vNodesCopy);
+                    return;
+                }
                 LogPrint(BCLog::GOBJECT,
                          "CSmartnodeSync::ProcessTick -- nTick %d nCurrentAsset %d nTimeLastBumped %lld GetTime() %lld diff %lld\n",
                          nTick, nCurrentAsset, nTimeLastBumped, GetTime(), GetTime() - nTimeLastBumped);
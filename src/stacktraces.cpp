@@ -526,6 +526,8 @@ static std::string GetCrashInfoStr(const crash_info &ci, size_t spaces) {
 
 static void PrintCrashInfo(const crash_info &ci) {
     auto str = GetCrashInfoStr(ci);
+    // Write out what the async logger queued before the crash, and the crash info right away
+    LogInstance().FlushAsyncLoggingOnCrash();
     LogPrintf("%s", str); /* Continued */
     tfm::format(std::cerr, "%s", str);
     fflush(stderr);
@@ -37,6 +37,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <cmath>
 #include <cstdio>
+#include <map>
+#include <unordered_map>
 
 statsd::StatsdClient statsClient;
 
@@ -69,16 +71,48 @@ namespace statsd {
         short port;
         bool init;
 
+        int64_t nFlushInterval{0};
+
         char errmsg[1024];
     };
 
+    /** A metric aggregated over one flush interval */
+    struct Metric {
+        char type{'c'}; // 'c' counter, 'g' gauge, 'd' gauge with decimals, 'm' timing
+        double value{0};
+        //! number of timings this metric stands for, including the ones dropped by sampling
+        double seen{0};
+        std::vector<size_t> samples;
+    };
+
+    struct Batch {
+        std::unordered_map<std::string, Metric> metrics;
+    };
+
+    /**
+     * The metrics of one thread. Only the owning thread writes to the current batch, Flush swaps in an empty batch
+     * and waits until the owner is done with the old one. fBusy is set before the owner loads the batch, so if the
+     * flusher sees it cleared after the swap the owner will use the new batch.
+     */
+    struct ThreadBuffer {
+        std::atomic<bool> fBusy{false};
+        std::atomic<Batch *> current{new Batch};
+
+        ~ThreadBuffer() {
+            delete current.load();
+        }
+    };
+
+    static std::atomic<uint64_t> nNextClientId{0};
+
     StatsdClient::StatsdClient(const std::string &host, int port, const std::string &ns) : d(
-            std::make_unique<_StatsdClientData>()) {
+            std::make_unique<_StatsdClientData>()), nClientId(nNextClientId++) {
         d->sock = INVALID_SOCKET;
         config(host, port, ns);
     }
 
     StatsdClient::~StatsdClient() {
+        StopFlushThread();
         // close socket
         CloseSocket(d->sock);
     }
@@ -91,9 +125,17 @@ namespace statsd {
         CloseSocket(d->sock);
     }
 
+    bool StatsdClient::enabled() {
+        int n = nEnabled.load(std::memory_order_relaxed);
+        if (n < 0) {
+            n = gArgs.GetBoolArg("-statsenabled", DEFAULT_STATSD_ENABLE) ? 1 : 0;
+            nEnabled = n;
+        }
+        return n == 1;
+    }
+
     int StatsdClient::init() {
-        static bool fEnabled = gArgs.GetBoolArg("-statsenabled", DEFAULT_STATSD_ENABLE);
-        if (!fEnabled) return -3;
+        if (!enabled()) return -3;
 
         if (d->init) return 0;
 
@@ -133,6 +175,15 @@ namespace statsd {
         }
     }
 
+    std::string StatsdClient::formatKey(std::string key) const {
+        // partition stats by node name if set
+        if (!d->nodename.empty())
+            key = key + "." + d->nodename;
+
+        cleanup(key);
+        return d->ns + key;
+    }
+
     int StatsdClient::dec(const std::string &key, float sample_rate) {
         return count(key, -1, sample_rate);
     }
@@ -158,46 +209,57 @@ namespace statsd {
     }
 
     int StatsdClient::send(std::string key, size_t value, const std::string &type, float sample_rate) {
+        if (!enabled()) {
+            return -3;
+        }
+
         if (!should_send(sample_rate)) {
             return 0;
         }
 
-        // partition stats by node name if set
-        if (!d->nodename.empty())
-            key = key + "." + d->nodename;
+        if (fBatching.load(std::memory_order_relaxed)) {
+            record(key, type == "ms" ? 'm' : type[0], type == "ms" ? (double) value : (double) (ssize_t) value,
+                   sample_rate);
+            return 0;
+        }
 
-        cleanup(key);
+        key = formatKey(std::move(key));
 
         char buf[256];
         if (fequal(sample_rate, 1.0)) {
-            snprintf(buf, sizeof(buf), "%s%s:%zd|%s",
-                     d->ns.c_str(), key.c_str(), (ssize_t) value, type.c_str());
+            snprintf(buf, sizeof(buf), "%s:%zd|%s",
+                     key.c_str(), (ssize_t) value, type.c_str());
         } else {
-            snprintf(buf, sizeof(buf), "%s%s:%zd|%s|@%.2f",
-                     d->ns.c_str(), key.c_str(), (ssize_t) value, type.c_str(), sample_rate);
+            snprintf(buf, sizeof(buf), "%s:%zd|%s|@%.2f",
+                     key.c_str(), (ssize_t) value, type.c_str(), sample_rate);
         }
 
         return send(buf);
     }
 
     int StatsdClient::sendDouble(std::string key, double value, const std::string &type, float sample_rate) {
+        if (!enabled()) {
+            return -3;
+        }
+
         if (!should_send(sample_rate)) {
             return 0;
         }
 
-        // partition stats by node name if set
-        if (!d->nodename.empty())
-            key = key + "." + d->nodename;
+        if (fBatching.load(std::memory_order_relaxed) && type == "g") {
+            record(key, 'd', value, sample_rate);
+            return 0;
+        }
 
-        cleanup(key);
+        key = formatKey(std::move(key));
 
         char buf[256];
         if (fequal(sample_rate, 1.0)) {
-            snprintf(buf, sizeof(buf), "%s%s:%f|%s",
-                     d->ns.c_str(), key.c_str(), value, type.c_str());
+            snprintf(buf, sizeof(buf), "%s:%f|%s",
+                     key.c_str(), value, type.c_str());
         } else {
-            snprintf(buf, sizeof(buf), "%s%s:%f|%s|@%.2f",
-                     d->ns.c_str(), key.c_str(), value, type.c_str(), sample_rate);
+            snprintf(buf, sizeof(buf), "%s:%f|%s|@%.2f",
+                     key.c_str(), value, type.c_str(), sample_rate);
         }
 
         return send(buf);
@@ -221,4 +283,182 @@ namespace statsd {
         return d->errmsg;
     }
 
+    ThreadBuffer &StatsdClient::threadBuffer() {
+        thread_local std::vector<std::pair<uint64_t, std::shared_ptr<ThreadBuffer>>> threadBuffers;
+        for (const auto &p: threadBuffers) {
+            if (p.first == nClientId) {
+                return *p.second;
+            }
+        }
+
+        // First metric of this thread, the only time recording takes a lock
+        auto buffer = std::make_shared<ThreadBuffer>();
+        {
+            LOCK(cs_buffers);
+            vBuffers.emplace_back(buffer);
+        }
+        threadBuffers.emplace_back(nClientId, buffer);
+        return *buffer;
+    }
+
+    void StatsdClient::record(const std::string &key, char type, double value, float sample_rate) {
+        ThreadBuffer &buffer = threadBuffer();
+
+        buffer.fBusy.store(true);
+        Metric &metric = buffer.current.load()->metrics[key];
+        metric.type = type;
+        switch (type) {
+            case 'c':
+                // Scale up, so the sum doesn't need a sample rate anymore
+                metric.value += value / sample_rate;
+                break;
+            case 'm':
+                metric.seen += 1.0 / sample_rate;
+                if (metric.samples.size() < MAX_STATSD_TIMINGS_PER_KEY) {
+                    metric.samples.emplace_back((size_t) value);
+                } else {
+                    // Reservoir sampling, every timing has the same chance to be kept
+                    const uint64_t pos = insecure_rand.randrange((uint64_t) std::ceil(metric.seen));
+                    if (pos < metric.samples.size()) {
+                        metric.samples[pos] = (size_t) value;
+                    }
+                }
+                break;
+            default:
+                metric.value = value;
+                break;
+        }
+        buffer.fBusy.store(false);
+    }
+
+    void StatsdClient::Flush() {
+        std::vector<std::unique_ptr<Batch>> vBatches;
+        {
+            LOCK(cs_buffers);
+            for (auto it = vBuffers.begin(); it != vBuffers.end();) {
+                ThreadBuffer &buffer = **it;
+                std::unique_ptr<Batch> batch(buffer.current.exchange(new Batch));
+                while (buffer.fBusy.load()) {
+                    std::this_thread::yield();
+                }
+                if (!batch->metrics.empty()) {
+                    vBatches.emplace_back(std::move(batch));
+                }
+                // Nobody else holds the buffer once its thread exited
+                if (it->use_count() == 1) {
+                    it = vBuffers.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        if (vBatches.empty() || init() != 0) {
+            return;
+        }
+
+        std::map<std::string, Metric> merged;
+        for (auto &batch: vBatches) {
+            for (auto &p: batch->metrics) {
+                Metric &metric = merged[p.first];
+                metric.type = p.second.type;
+                if (metric.type == 'c') {
+                    metric.value += p.second.value;
+                } else if (metric.type == 'm') {
+                    metric.seen += p.second.seen;
+                    metric.samples.insert(metric.samples.end(), p.second.samples.begin(), p.second.samples.end());
+                } else {
+                    metric.value = p.second.value;
+                }
+            }
+        }
+
+        std::string packet;
+        auto add = [&](const std::string &line) {
+            if (!packet.empty() && packet.size() + 1 + line.size() > MAX_STATSD_PACKET_SIZE) {
+                send(packet);
+                packet.clear();
+            }
+            if (!packet.empty()) {
+                packet += '\n';
+            }
+            packet += line;
+        };
+
+        for (auto &p: merged) {
+            const std::string key = formatKey(p.first);
+            Metric &metric = p.second;
+            switch (metric.type) {
+                case 'c':
+                    add(strprintf("%s:%d|c", key, (int64_t) std::llround(metric.value)));
+                    break;
+                case 'g':
+                    add(strprintf("%s:%d|g", key, (int64_t) metric.value));
+                    break;
+                case 'd':
+                    add(strprintf("%s:%f|g", key, metric.value));
+                    break;
+                case 'm': {
+                    if (metric.samples.size() > MAX_STATSD_TIMINGS_PER_KEY) {
+                        Shuffle(metric.samples.begin(), metric.samples.end(), insecure_rand);
+                        metric.samples.resize(MAX_STATSD_TIMINGS_PER_KEY);
+                    }
+                    const double rate = metric.samples.size() / metric.seen;
+                    for (size_t ms: metric.samples) {
+                        if (rate < 0.9999) {
+                            add(strprintf("%s:%u|ms|@%.4f", key, ms, rate));
+                        } else {
+                            add(strprintf("%s:%u|ms", key, ms));
+                        }
+                    }
+                    break;
+                }
+            }
+        }
+        if (!packet.empty()) {
+            send(packet);
+        }
+    }
+
+    void StatsdClient::threadFlush() {
+        while (true) {
+            {
+                WAIT_LOCK(cs_flush_thread, lock);
+                cond_flush_thread.wait_for(lock, std::chrono::milliseconds(d->nFlushInterval),
+                                           [this]() EXCLUSIVE_LOCKS_REQUIRED(cs_flush_thread) { return fStopFlushThread; });
+                if (fStopFlushThread) {
+                    return;
+                }
+            }
+            Flush();
+        }
+    }
+
+    void StatsdClient::StartFlushThread(int64_t nIntervalMs) {
+        if (nIntervalMs <= 0 || !enabled() || flushThread.joinable()) {
+            return;
+        }
+        d->nFlushInterval = nIntervalMs;
+        {
+            LOCK(cs_flush_thread);
+            fStopFlushThread = false;
+        }
+        fBatching = true;
+        flushThread = std::thread(&TraceThread < std::function < void() > > , "statsd",
+                                  std::function<void()>(std::bind(&StatsdClient::threadFlush, this)));
+    }
+
+    void StatsdClient::StopFlushThread() {
+        if (!flushThread.joinable()) {
+            return;
+        }
+        {
+            LOCK(cs_flush_thread);
+            fStopFlushThread = true;
+        }
+        cond_flush_thread.notify_all();
+        flushThread.join();
+        fBatching = false;
+        Flush();
+    }
+
 } // namespace statsd
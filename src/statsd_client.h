@@ -1,8 +1,15 @@
 #ifndef BITCOIN_STATSD_CLIENT_H
 #define BITCOIN_STATSD_CLIENT_H
 
-#include <string>
+#include <sync.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 static const bool DEFAULT_STATSD_ENABLE = false;
 static const int DEFAULT_STATSD_PORT = 8125;
@@ -15,10 +22,19 @@ static const int DEFAULT_STATSD_PERIOD = 60;
 static const int MIN_STATSD_PERIOD = 5;
 static const int MAX_STATSD_PERIOD = 60 * 60;
 
+// aggregate metrics in memory and send them in batches, in milliseconds. 0 - send every metric right away
+static const int64_t DEFAULT_STATSD_FLUSH_INTERVAL = 1000;
+// keep a packet within the MTU of a local network
+static const size_t MAX_STATSD_PACKET_SIZE = 1432;
+// timing samples kept per key and flush interval, more are sampled down
+static const size_t MAX_STATSD_TIMINGS_PER_KEY = 64;
+
 namespace statsd {
 
     struct _StatsdClientData;
 
+    struct ThreadBuffer;
+
     class StatsdClient {
     public:
         StatsdClient(const std::string &host = DEFAULT_STATSD_HOST, int port = DEFAULT_STATSD_PORT,
@@ -61,13 +77,51 @@ namespace statsd {
         int sendDouble(std::string key, double value,
                        const std::string &type, float sample_rate);
 
+    public:
+        /**
+         * Aggregate metrics in per-thread buffers instead of sending each of them, a background thread sends them
+         * as multi-metric packets every nIntervalMs milliseconds. Recording a metric takes no lock.
+         */
+        void StartFlushThread(int64_t nIntervalMs);
+
+        /** Send what's buffered and go back to sending every metric right away */
+        void StopFlushThread();
+
+        /** Send all buffered metrics now */
+        void Flush();
+
     protected:
         int init();
 
+        bool enabled();
+
         static void cleanup(std::string &key);
 
+        std::string formatKey(std::string key) const;
+
+        /** Add a metric to the buffer of the calling thread, sample_rate is already applied */
+        void record(const std::string &key, char type, double value, float sample_rate);
+
+        ThreadBuffer &threadBuffer();
+
+        void threadFlush();
+
     protected:
         std::unique_ptr<struct _StatsdClientData> d;
+
+        //! -1 until the -statsenabled setting is known
+        std::atomic<int> nEnabled{-1};
+        std::atomic<bool> fBatching{false};
+        //! distinguishes the buffers of several clients in the same thread
+        const uint64_t nClientId;
+
+        Mutex cs_buffers;
+        std::vector<std::shared_ptr<ThreadBuffer>> vBuffers GUARDED_BY(cs_buffers);
+
+        Mutex cs_flush_thread;
+        std::condition_variable cond_flush_thread;
+        bool fStopFlushThread GUARDED_BY(cs_flush_thread){false};
+        std::thread flushThread;
     };
 
 } // namespace statsd
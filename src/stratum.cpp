@@ -0,0 +1,602 @@
+// Copyright (c) 2025 The 405Coin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <stratum.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <crypto/common.h>
+#include <key_io.h>
+#include <logging.h>
+#include <metrics.h>
+#include <miner.h>
+#include <netbase.h>
+#include <node/context.h>
+#include <random.h>
+#include <streams.h>
+#include <timedata.h>
+#include <txmempool.h>
+#include <ui_interface.h>
+#include <univalue.h>
+#include <util/strencodings.h>
+#include <util/string.h>
+#include <util/system.h>
+#include <util/time.h>
+#include <validation.h>
+#include <version.h>
+
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+#include <event2/listener.h>
+#include <event2/thread.h>
+
+#include <algorithm>
+#include <functional>
+
+//! Longest line accepted from a miner, a submit is far below
+static const size_t MAX_STRATUM_LINE_LENGTH = 4096;
+//! Shares can be submitted for this many of the most recent jobs, until the tip changes
+static const size_t MAX_STRATUM_JOBS = 16;
+
+/** Error codes used by stratum pools */
+enum StratumError {
+    STRATUM_ERROR_OTHER = 20,
+    STRATUM_ERROR_JOB_NOT_FOUND = 21,
+    STRATUM_ERROR_DUPLICATE_SHARE = 22,
+    STRATUM_ERROR_LOW_DIFFICULTY = 23,
+    STRATUM_ERROR_UNAUTHORIZED = 24,
+    STRATUM_ERROR_NOT_SUBSCRIBED = 25,
+};
+
+std::vector<uint256> ComputeCoinbaseMerkleBranch(std::vector<uint256> leaves) {
+    std::vector<uint256> branch;
+    while (leaves.size() > 1) {
+        // The coinbase stays on the left, the hashes involving it are never used
+        branch.push_back(leaves[1]);
+        if (leaves.size() & 1) {
+            leaves.push_back(leaves.back());
+        }
+        for (size_t i = 0; i < leaves.size() / 2; i++) {
+            leaves[i] = Hash(leaves[2 * i].begin(), leaves[2 * i].end(), leaves[2 * i + 1].begin(),
+                             leaves[2 * i + 1].end());
+        }
+        leaves.resize(leaves.size() / 2);
+    }
+    return branch;
+}
+
+uint256 ComputeMerkleRootFromBranch(const uint256 &coinbaseHash, const std::vector<uint256> &branch) {
+    uint256 hash = coinbaseHash;
+    for (const uint256 &h: branch) {
+        hash = Hash(hash.begin(), hash.end(), h.begin(), h.end());
+    }
+    return hash;
+}
+
+arith_uint256 GetStratumShareTarget(double difficulty, const arith_uint256 &powLimit) {
+    arith_uint256 target;
+    target.SetCompact(0x1d00ffff);
+    if (!(difficulty > 0)) {
+        return powLimit;
+    }
+    if (difficulty >= 1) {
+        // Keep three decimals of the difficulty
+        target *= 1000;
+        target /= arith_uint256((uint64_t) std::min(difficulty * 1000, 1e19));
+    } else {
+        const arith_uint256 multiplier((uint64_t) std::min(1 / difficulty, 1e19));
+        if (powLimit / multiplier < target) {
+            return powLimit;
+        }
+        target *= multiplier;
+    }
+    return std::min(target, powLimit);
+}
+
+/** Stratum sends the previous block hash as the bytes of the header, with the bytes of each 32-bit word swapped */
+static std::string GetStratumPrevHash(const uint256 &hash) {
+    std::vector<unsigned char> vch(hash.begin(), hash.end());
+    for (size_t i = 0; i < vch.size(); i += 4) {
+        std::reverse(vch.begin() + i, vch.begin() + i + 4);
+    }
+    return HexStr(vch);
+}
+
+/** Version, nBits, nTime and nNonce are sent as 8 hex digits, most significant first */
+static bool ParseStratumUInt32(const UniValue &value, uint32_t &n) {
+    if (!value.isStr() || value.get_str().size() != 8 || !IsHex(value.get_str())) {
+        return false;
+    }
+    n = ReadBE32(ParseHex(value.get_str()).data());
+    return true;
+}
+
+CStratumServer::CStratumServer(ChainstateManager &_chainman, CTxMemPool &_mempool, const Options &_options) :
+        chainman(_chainman),
+        mempool(_mempool),
+        options(_options),
+        shareTarget(GetStratumShareTarget(_options.difficulty, UintToArith256(Params().GetConsensus().powLimit))),
+        nNextExtranonce1(GetRand(std::numeric_limits<uint32_t>::max())) {
+}
+
+CStratumServer::~CStratumServer() {
+    Stop();
+}
+
+bool CStratumServer::Start() {
+#ifdef WIN32
+    evthread_use_windows_threads();
+#else
+    evthread_use_pthreads();
+#endif
+    base = raii_event_base(event_base_new());
+    if (!base) {
+        LogPrintf("stratum: Unable to create event_base\n");
+        return false;
+    }
+
+    struct sockaddr_storage sockaddr;
+    socklen_t len = sizeof(sockaddr);
+    if (!options.bindAddr.GetSockAddr((struct sockaddr *) &sockaddr, &len)) {
+        LogPrintf("stratum: Unsupported bind address %s\n", options.bindAddr.ToString());
+        return false;
+    }
+    listener = evconnlistener_new_bind(base.get(), AcceptCallback, this, LEV_OPT_CLOSE_ON_FREE | LEV_OPT_REUSEABLE,
+                                       -1, (struct sockaddr *) &sockaddr, len);
+    if (!listener) {
+        LogPrintf("stratum: Unable to bind to %s\n", options.bindAddr.ToString());
+        return false;
+    }
+    len = sizeof(sockaddr);
+    CService addrBound;
+    if (getsockname(evconnlistener_get_fd(listener), (struct sockaddr *) &sockaddr, &len) == 0 &&
+        addrBound.SetSockAddr((const struct sockaddr *) &sockaddr)) {
+        nPort = addrBound.GetPort();
+    }
+
+    jobTimer = obtain_event(base.get(), -1, EV_PERSIST, JobTimerCallback, this);
+    struct timeval tv = MillisToTimeval(std::max<int64_t>(options.nJobInterval, 1) * 1000);
+    event_add(jobTimer.get(), &tv);
+
+    // The first job is built on the server thread, like all the others
+    event_base_once(base.get(), -1, EV_TIMEOUT, [](evutil_socket_t, short, void *ctx) {
+        static_cast<CStratumServer *>(ctx)->UpdateJob(true);
+    }, this, nullptr);
+    RegisterValidationInterface(this);
+
+    thread = std::thread(&TraceThread<std::function<void()>>, "stratum", std::function<void()>([this] {
+        event_base_dispatch(base.get());
+    }));
+    LogPrintf("stratum: Listening on %s\n", CService(options.bindAddr, nPort).ToString());
+    return true;
+}
+
+void CStratumServer::Interrupt() {
+    if (base) {
+        // Also breaks the loop if it didn't start yet
+        event_base_once(base.get(), -1, EV_TIMEOUT, [](evutil_socket_t, short, void *ctx) {
+            event_base_loopbreak(static_cast<struct event_base *>(ctx));
+        }, base.get(), nullptr);
+    }
+}
+
+void CStratumServer::Stop() {
+    if (thread.joinable()) {
+        UnregisterValidationInterface(this);
+        // A callback already queued may still schedule an event on the base
+        SyncWithValidationInterfaceQueue();
+        Interrupt();
+        thread.join();
+    }
+    for (auto &p: mapClients) {
+        bufferevent_free(p.second->bev);
+    }
+    mapClients.clear();
+    if (listener) {
+        evconnlistener_free(listener);
+        listener = nullptr;
+    }
+    jobTimer.reset();
+    base.reset();
+}
+
+void CStratumServer::UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork,
+                                     bool fInitialDownload) {
+    if (pindexNew == pindexFork || (fInitialDownload && !Params().MineBlocksOnDemand())) {
+        return;
+    }
+    event_base_once(base.get(), -1, EV_TIMEOUT, [](evutil_socket_t, short, void *ctx) {
+        static_cast<CStratumServer *>(ctx)->UpdateJob(true);
+    }, this, nullptr);
+}
+
+void CStratumServer::JobTimerCallback(evutil_socket_t, short, void *ctx) {
+    auto server = static_cast<CStratumServer *>(ctx);
+    if (server->jobs.empty()) {
+        server->UpdateJob(true);
+    } else if (server->mempool.GetTransactionsUpdated() != server->nTransactionsUpdatedLast) {
+        server->UpdateJob(false);
+    }
+}
+
+std::shared_ptr<CStratumServer::Job> CStratumServer::CreateJob() {
+    static auto &histJob = metrics::GetRegistry().GetHistogram("stratum_job_ms", "Time to build a stratum job");
+    metrics::HistogramTimer timer(histJob);
+
+    nTransactionsUpdatedLast = mempool.GetTransactionsUpdated();
+    std::unique_ptr<CBlockTemplate> pblocktemplate =
+            options.templateBuilder ? options.templateBuilder->GetTemplate(options.scriptPubKey)
+                                    : BlockAssembler(mempool, Params()).CreateNewBlock(options.scriptPubKey);
+    if (!pblocktemplate) {
+        return nullptr;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->block = std::move(pblocktemplate->block);
+    {
+        LOCK(cs_main);
+        const CBlockIndex *pindexPrev = LookupBlockIndex(job->block.hashPrevBlock);
+        assert(pindexPrev);
+        job->nHeight = pindexPrev->nHeight + 1;
+        job->nMinTime = pindexPrev->GetMedianTimePast() + 1;
+    }
+    job->id = strprintf("%x", nNextJobId++);
+    job->blockTarget.SetCompact(job->block.nBits);
+    job->schedule = std::make_unique<GRSchedule>(job->block.hashPrevBlock);
+
+    // Same layout as IncrementExtraNonce, with both extranonces pushed as a single item
+    const CScript scriptHeight = CScript() << job->nHeight;
+    CScript scriptSig = scriptHeight;
+    scriptSig << std::vector<unsigned char>(STRATUM_EXTRANONCE1_SIZE + STRATUM_EXTRANONCE2_SIZE);
+    scriptSig += COINBASE_FLAGS;
+    if (scriptSig.size() > 100) {
+        throw std::runtime_error("coinbase flags too long for the extranonce");
+    }
+    CMutableTransaction coinbase(*job->block.vtx[0]);
+    coinbase.vin[0].scriptSig = scriptSig;
+
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << coinbase;
+    const size_t nExtranonceOffset = sizeof(int32_t) + GetSizeOfCompactSize(coinbase.vin.size()) +
+                                     ::GetSerializeSize(coinbase.vin[0].prevout, PROTOCOL_VERSION) +
+                                     GetSizeOfCompactSize(scriptSig.size()) + scriptHeight.size() + 1;
+    job->coinb1.assign(ss.begin(), ss.begin() + nExtranonceOffset);
+    job->coinb2.assign(ss.begin() + nExtranonceOffset + STRATUM_EXTRANONCE1_SIZE + STRATUM_EXTRANONCE2_SIZE,
+                       ss.end());
+    job->block.vtx[0] = MakeTransactionRef(std::move(coinbase));
+
+    std::vector<uint256> leaves;
+    leaves.reserve(job->block.vtx.size());
+    for (const auto &tx: job->block.vtx) {
+        leaves.push_back(tx->GetHash());
+    }
+    job->merkleBranch = ComputeCoinbaseMerkleBranch(std::move(leaves));
+    return job;
+}
+
+void CStratumServer::UpdateJob(bool fClean) {
+    if (!Params().MineBlocksOnDemand() && ::ChainstateActive().IsInitialBlockDownload()) {
+        return;
+    }
+
+    std::shared_ptr<Job> job;
+    try {
+        job = CreateJob();
+    } catch (const std::exception &e) {
+        LogPrintf("stratum: Unable to create a job: %s\n", e.what());
+    }
+    if (!job) {
+        return;
+    }
+
+    // A job may have been built for a new tip before its notification arrived
+    if (!jobs.empty() && jobs.back()->block.hashPrevBlock != job->block.hashPrevBlock) {
+        fClean = true;
+    }
+    if (fClean) {
+        jobs.clear();
+    }
+    jobs.push_back(job);
+    while (jobs.size() > MAX_STRATUM_JOBS) {
+        jobs.pop_front();
+    }
+
+    LogPrint(BCLog::STRATUM, "stratum: New job %s at height %d with %u transactions for %u miners\n", job->id,
+             job->nHeight, job->block.vtx.size(), mapClients.size());
+    for (auto &p: mapClients) {
+        if (p.second->fSubscribed && p.second->fAuthorized) {
+            SendJob(*p.second, *job, fClean);
+        }
+    }
+}
+
+void CStratumServer::SendJob(Client &client, const Job &job, bool fClean) {
+    UniValue branch(UniValue::VARR);
+    for (const uint256 &hash: job.merkleBranch) {
+        branch.push_back(HexStr(hash));
+    }
+
+    UniValue params(UniValue::VARR);
+    params.push_back(job.id);
+    params.push_back(GetStratumPrevHash(job.block.hashPrevBlock));
+    params.push_back(HexStr(job.coinb1));
+    params.push_back(HexStr(job.coinb2));
+    params.push_back(branch);
+    params.push_back(strprintf("%08x", (uint32_t) job.block.nVersion));
+    params.push_back(strprintf("%08x", job.block.nBits));
+    params.push_back(strprintf("%08x", job.block.nTime));
+    params.push_back(fClean);
+
+    UniValue msg(UniValue::VOBJ);
+    msg.pushKV("id", NullUniValue);
+    msg.pushKV("method", "mining.notify");
+    msg.pushKV("params", params);
+    Send(client, msg);
+}
+
+void CStratumServer::Send(Client &client, const UniValue &msg) {
+    const std::string str = msg.write() + "\n";
+    bufferevent_write(client.bev, str.data(), str.size());
+}
+
+void CStratumServer::Reply(Client &client, const UniValue &id, const UniValue &result, int nErrorCode,
+                           const std::string &strError) {
+    UniValue msg(UniValue::VOBJ);
+    msg.pushKV("id", id);
+    if (nErrorCode) {
+        UniValue error(UniValue::VARR);
+        error.push_back(nErrorCode);
+        error.push_back(strError);
+        error.push_back(NullUniValue);
+        msg.pushKV("result", NullUniValue);
+        msg.pushKV("error", error);
+    } else {
+        msg.pushKV("result", result);
+        msg.pushKV("error", NullUniValue);
+    }
+    Send(client, msg);
+}
+
+void CStratumServer::HandleLine(Client &client, const std::string &line) {
+    UniValue request;
+    if (!request.read(line) || !request.isObject()) {
+        LogPrint(BCLog::STRATUM, "stratum: Invalid message from %s\n", client.peer);
+        return;
+    }
+    const UniValue &id = find_value(request, "id");
+    const UniValue &method = find_value(request, "method");
+    const UniValue &params = find_value(request, "params");
+    if (!method.isStr()) {
+        Reply(client, id, NullUniValue, STRATUM_ERROR_OTHER, "Method not found");
+        return;
+    }
+
+    const std::string &strMethod = method.get_str();
+    if (strMethod == "mining.subscribe") {
+        UniValue notify(UniValue::VARR);
+        notify.push_back("mining.notify");
+        notify.push_back(strprintf("%x", client.id));
+        UniValue subscriptions(UniValue::VARR);
+        subscriptions.push_back(notify);
+        UniValue result(UniValue::VARR);
+        result.push_back(subscriptions);
+        result.push_back(HexStr(client.extranonce1));
+        result.push_back(STRATUM_EXTRANONCE2_SIZE);
+        Reply(client, id, result);
+        client.fSubscribed = true;
+    } else if (strMethod == "mining.authorize") {
+        // The reward goes to -stratumaddress, the worker name is only informative
+        const std::string strWorker = params.isArray() && params.size() > 0 && params[0].isStr() ? params[0].get_str()
+                                                                                                 : "";
+        LogPrint(BCLog::STRATUM, "stratum: Worker %s authorized from %s\n", SanitizeString(strWorker), client.peer);
+        Reply(client, id, true);
+        client.fAuthorized = true;
+    } else if (strMethod == "mining.submit") {
+        std::string strError;
+        const int nErrorCode = SubmitShare(client, params, strError);
+        Reply(client, id, true, nErrorCode, strError);
+        return;
+    } else if (strMethod == "mining.extranonce.subscribe") {
+        // The extranonce of a connection never changes
+        Reply(client, id, false);
+        return;
+    } else {
+        Reply(client, id, NullUniValue, STRATUM_ERROR_OTHER, "Method not found");
+        return;
+    }
+
+    // Work starts as soon as the miner is both subscribed and authorized, in either order
+    if (client.fSubscribed && client.fAuthorized && !jobs.empty() &&
+        (strMethod == "mining.subscribe" || strMethod == "mining.authorize")) {
+        UniValue difficulty(UniValue::VARR);
+        difficulty.push_back(options.difficulty);
+        UniValue msg(UniValue::VOBJ);
+        msg.pushKV("id", NullUniValue);
+        msg.pushKV("method", "mining.set_difficulty");
+        msg.pushKV("params", difficulty);
+        Send(client, msg);
+        SendJob(client, *jobs.back(), true);
+    }
+}
+
+int CStratumServer::SubmitShare(Client &client, const UniValue &params, std::string &strError) {
+    static auto &counterAccepted = metrics::GetRegistry().GetCounter("stratum_shares_accepted",
+                                                                     "Shares accepted by the stratum server");
+    static auto &counterRejected = metrics::GetRegistry().GetCounter("stratum_shares_rejected",
+                                                                     "Shares rejected by the stratum server");
+    static auto &counterBlocks = metrics::GetRegistry().GetCounter("stratum_blocks_found",
+                                                                   "Blocks found by stratum miners");
+    static auto &histShare = metrics::GetRegistry().GetHistogram("stratum_share_check_ms",
+                                                                 "Time to check a stratum share");
+    metrics::HistogramTimer timer(histShare);
+
+    auto reject = [&](int nErrorCode, const std::string &str) {
+        counterRejected.Inc();
+        strError = str;
+        LogPrint(BCLog::STRATUM, "stratum: Rejected share from %s: %s\n", client.peer, str);
+        return nErrorCode;
+    };
+
+    if (!client.fSubscribed) {
+        return reject(STRATUM_ERROR_NOT_SUBSCRIBED, "Not subscribed");
+    }
+    if (!client.fAuthorized) {
+        return reject(STRATUM_ERROR_UNAUTHORIZED, "Unauthorized worker");
+    }
+    // [worker, job id, extranonce2, ntime, nonce]
+    if (!params.isArray() || params.size() < 5 || !params[1].isStr() || !params[2].isStr()) {
+        return reject(STRATUM_ERROR_OTHER, "Invalid parameters");
+    }
+    const std::string &strJobId = params[1].get_str();
+    auto it = std::find_if(jobs.begin(), jobs.end(), [&](const std::shared_ptr<Job> &job) {
+        return job->id == strJobId;
+    });
+    if (it == jobs.end()) {
+        return reject(STRATUM_ERROR_JOB_NOT_FOUND, "Job not found");
+    }
+    Job &job = **it;
+
+    const std::string &strExtranonce2 = params[2].get_str();
+    uint32_t nTime, nNonce;
+    if (strExtranonce2.size() != STRATUM_EXTRANONCE2_SIZE * 2 || !IsHex(strExtranonce2) ||
+        !ParseStratumUInt32(params[3], nTime) || !ParseStratumUInt32(params[4], nNonce)) {
+        return reject(STRATUM_ERROR_OTHER, "Invalid parameters");
+    }
+    if (nTime < job.nMinTime || nTime > GetAdjustedTime() + MAX_FUTURE_BLOCK_TIME) {
+        return reject(STRATUM_ERROR_OTHER, "Time out of range");
+    }
+    if (!job.setShares.emplace(HexStr(client.extranonce1) + strExtranonce2 + params[3].get_str() +
+                               params[4].get_str()).second) {
+        return reject(STRATUM_ERROR_DUPLICATE_SHARE, "Duplicate share");
+    }
+
+    std::vector<unsigned char> extranonce(client.extranonce1);
+    const std::vector<unsigned char> extranonce2 = ParseHex(strExtranonce2);
+    extranonce.insert(extranonce.end(), extranonce2.begin(), extranonce2.end());
+    CMutableTransaction coinbase(*job.block.vtx[0]);
+    coinbase.vin[0].scriptSig = (CScript() << job.nHeight << extranonce) + COINBASE_FLAGS;
+
+    CBlockHeader header = job.block;
+    header.hashMerkleRoot = ComputeMerkleRootFromBranch(coinbase.GetHash(), job.merkleBranch);
+    header.nTime = nTime;
+    header.nNonce = nNonce;
+    const arith_uint256 hash = UintToArith256(header.ComputeHash(*job.schedule));
+    if (hash > shareTarget && hash > job.blockTarget) {
+        return reject(STRATUM_ERROR_LOW_DIFFICULTY, "Low difficulty share");
+    }
+    counterAccepted.Inc();
+
+    if (hash <= job.blockTarget) {
+        auto pblock = std::make_shared<CBlock>(job.block);
+        pblock->vtx[0] = MakeTransactionRef(std::move(coinbase));
+        pblock->hashMerkleRoot = header.hashMerkleRoot;
+        pblock->nTime = nTime;
+        pblock->nNonce = nNonce;
+        LogPrintf("stratum: Block %s found at height %d by %s\n", pblock->GetHash().ToString(), job.nHeight,
+                  client.peer);
+        bool fNewBlock = false;
+        if (chainman.ProcessNewBlock(Params(), pblock, true, &fNewBlock) && fNewBlock) {
+            counterBlocks.Inc();
+        } else {
+            LogPrintf("stratum: Block %s was not accepted\n", pblock->GetHash().ToString());
+        }
+    }
+    return 0;
+}
+
+void CStratumServer::Disconnect(Client &client) {
+    LogPrint(BCLog::STRATUM, "stratum: Miner %s disconnected\n", client.peer);
+    bufferevent_free(client.bev);
+    mapClients.erase(client.id);
+}
+
+void CStratumServer::AcceptCallback(struct evconnlistener *, evutil_socket_t fd, struct sockaddr *addr, int,
+                                    void *ctx) {
+    auto server = static_cast<CStratumServer *>(ctx);
+    struct bufferevent *bev = bufferevent_socket_new(server->base.get(), fd, BEV_OPT_CLOSE_ON_FREE);
+    if (!bev) {
+        evutil_closesocket(fd);
+        return;
+    }
+
+    auto client = std::make_unique<Client>();
+    client->server = server;
+    client->bev = bev;
+    client->id = server->nNextClientId++;
+    CService peer;
+    client->peer = peer.SetSockAddr(addr) ? peer.ToString() : "unknown";
+    client->extranonce1.resize(STRATUM_EXTRANONCE1_SIZE);
+    WriteBE32(client->extranonce1.data(), server->nNextExtranonce1++);
+
+    bufferevent_setcb(bev, ReadCallback, nullptr, EventCallback, client.get());
+    bufferevent_enable(bev, EV_READ | EV_WRITE);
+    LogPrint(BCLog::STRATUM, "stratum: Miner connected from %s\n", client->peer);
+    server->mapClients.emplace(client->id, std::move(client));
+}
+
+void CStratumServer::ReadCallback(struct bufferevent *bev, void *ctx) {
+    Client &client = *static_cast<Client *>(ctx);
+    struct evbuffer *input = bufferevent_get_input(bev);
+    size_t n_read_out = 0;
+    char *line;
+    while ((line = evbuffer_readln(input, &n_read_out, EVBUFFER_EOL_CRLF)) != nullptr) {
+        const std::string s(line, n_read_out);
+        free(line);
+        client.server->HandleLine(client, s);
+    }
+    if (evbuffer_get_length(input) > MAX_STRATUM_LINE_LENGTH) {
+        LogPrint(BCLog::STRATUM, "stratum: Line too long from %s\n", client.peer);
+        client.server->Disconnect(client);
+    }
+}
+
+void CStratumServer::EventCallback(struct bufferevent *, short what, void *ctx) {
+    Client &client = *static_cast<Client *>(ctx);
+    if (what & (BEV_EVENT_EOF | BEV_EVENT_ERROR)) {
+        client.server->Disconnect(client);
+    }
+}
+
+static std::unique_ptr<CStratumServer> g_stratum_server;
+
+bool StartStratum(NodeContext &node) {
+    if (!gArgs.GetBoolArg("-stratum", DEFAULT_STRATUM_ENABLE)) {
+        return true;
+    }
+
+    CStratumServer::Options options;
+    const CTxDestination dest = DecodeDestination(gArgs.GetArg("-stratumaddress", ""));
+    if (!IsValidDestination(dest)) {
+        return InitError(_("-stratum requires -stratumaddress to be set to a valid address"));
+    }
+    options.scriptPubKey = GetScriptForDestination(dest);
+    const std::string strBind = gArgs.GetArg("-stratumbind", DEFAULT_STRATUM_BIND);
+    if (!Lookup(strBind.c_str(), options.bindAddr, gArgs.GetArg("-stratumport", DEFAULT_STRATUM_PORT), false)) {
+        return InitError(strprintf(_("Cannot resolve -stratumbind address: '%s'"), strBind));
+    }
+    const std::string strDifficulty = gArgs.GetArg("-stratumdifficulty", ToString(DEFAULT_STRATUM_DIFFICULTY));
+    if (!ParseDouble(strDifficulty, &options.difficulty) || !(options.difficulty > 0)) {
+        return InitError(strprintf(_("Invalid -stratumdifficulty: '%s'"), strDifficulty));
+    }
+    options.nJobInterval = gArgs.GetArg("-stratumjobinterval", DEFAULT_STRATUM_JOB_INTERVAL);
+    options.templateBuilder = node.template_builder.get();
+
+    g_stratum_server = std::make_unique<CStratumServer>(EnsureChainman(node), *node.mempool, options);
+    if (!g_stratum_server->Start()) {
+        g_stratum_server.reset();
+        return InitError(strprintf(_("Unable to start the stratum server on %s"),
+                                   options.bindAddr.ToString()));
+    }
+    return true;
+}
+
+void InterruptStratum() {
+    if (g_stratum_server) {
+        g_stratum_server->Interrupt();
+    }
+}
+
+void StopStratum() {
+    g_stratum_server.reset();
+}
@@ -0,0 +1,176 @@
+// Copyright (c) 2025 The 405Coin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_STRATUM_H
+#define BITCOIN_STRATUM_H
+
+#include <arith_uint256.h>
+#include <hash.h>
+#include <netaddress.h>
+#include <primitives/block.h>
+#include <script/script.h>
+#include <support/events.h>
+#include <validationinterface.h>
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+class BlockTemplateBuilder;
+struct bufferevent;
+class ChainstateManager;
+class CTxMemPool;
+struct evconnlistener;
+struct NodeContext;
+class UniValue;
+
+static const bool DEFAULT_STRATUM_ENABLE = false;
+static const uint16_t DEFAULT_STRATUM_PORT = 3405;
+static const std::string DEFAULT_STRATUM_BIND = "127.0.0.1";
+static const double DEFAULT_STRATUM_DIFFICULTY = 1;
+//! Seconds between rebuilding the job when only the mempool changed, same as getblocktemplate
+static const int64_t DEFAULT_STRATUM_JOB_INTERVAL = 5;
+
+/** Bytes of the extranonce assigned by the server, and of the one rolled by the miner */
+static const int STRATUM_EXTRANONCE1_SIZE = 4;
+static const int STRATUM_EXTRANONCE2_SIZE = 4;
+
+/**
+ * Merkle branch of the first transaction of a block, hashing the coinbase with each branch entry in turn gives the
+ * merkle root. leaves are the transaction hashes, the first one is ignored.
+ */
+std::vector<uint256> ComputeCoinbaseMerkleBranch(std::vector<uint256> leaves);
+
+uint256 ComputeMerkleRootFromBranch(const uint256 &coinbaseHash, const std::vector<uint256> &branch);
+
+/** Share target for a stratum difficulty, difficulty 1 is the target of nBits 0x1d00ffff. Never above powLimit. */
+arith_uint256 GetStratumShareTarget(double difficulty, const arith_uint256 &powLimit);
+
+/**
+ * Stratum (v1) work server, an alternative to pools polling getblocktemplate.
+ *
+ * Miners connect over TCP and exchange JSON-RPC messages, one per line: mining.subscribe, mining.authorize and
+ * mining.submit from the miner, mining.set_difficulty and mining.notify from the server. A job is prepared once for
+ * all miners when the tip changes, or when the mempool changed and the job interval has passed: the coinbase is split
+ * around the extranonce and the merkle branch of the coinbase is computed, so a miner only hashes its coinbase and the
+ * branch. The GhostRider schedule only depends on the previous block, so it's computed once per job to check shares.
+ * A share meeting the block target is submitted right away.
+ *
+ * All connections and jobs are handled on a single libevent thread.
+ */
+class CStratumServer : public CValidationInterface {
+public:
+    struct Options {
+        CService bindAddr;
+        //! Receives the block reward
+        CScript scriptPubKey;
+        double difficulty{DEFAULT_STRATUM_DIFFICULTY};
+        int64_t nJobInterval{DEFAULT_STRATUM_JOB_INTERVAL};
+        //! Jobs are built from its templates if set, otherwise from scratch
+        BlockTemplateBuilder *templateBuilder{nullptr};
+    };
+
+    CStratumServer(ChainstateManager &chainman, CTxMemPool &mempool, const Options &options);
+
+    ~CStratumServer();
+
+    /** Starts listening and the server thread, returns false if the address can't be bound */
+    bool Start();
+
+    void Interrupt();
+
+    void Stop();
+
+    /** Listening port, useful when binding port 0 */
+    uint16_t GetPort() const { return nPort; }
+
+protected:
+    void UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload) override;
+
+private:
+    struct Job {
+        std::string id;
+        CBlock block;
+        int nHeight;
+        //! Serialized coinbase before and after the extranonces
+        std::vector<unsigned char> coinb1, coinb2;
+        std::vector<uint256> merkleBranch;
+        std::unique_ptr<GRSchedule> schedule;
+        arith_uint256 blockTarget;
+        int64_t nMinTime;
+        //! Submitted extranonce1, extranonce2, ntime and nonce, to reject duplicates
+        std::set<std::string> setShares;
+    };
+
+    struct Client {
+        CStratumServer *server;
+        struct bufferevent *bev;
+        uint64_t id;
+        std::string peer;
+        std::vector<unsigned char> extranonce1;
+        bool fSubscribed{false};
+        bool fAuthorized{false};
+    };
+
+    ChainstateManager &chainman;
+    CTxMemPool &mempool;
+    const Options options;
+    const arith_uint256 shareTarget;
+
+    raii_event_base base;
+    raii_event jobTimer;
+    struct evconnlistener *listener{nullptr};
+    std::thread thread;
+    uint16_t nPort{0};
+
+    std::map<uint64_t, std::unique_ptr<Client>> mapClients;
+    uint64_t nNextClientId{0};
+    uint32_t nNextExtranonce1;
+
+    //! Most recent job last
+    std::deque<std::shared_ptr<Job>> jobs;
+    uint64_t nNextJobId{0};
+    unsigned int nTransactionsUpdatedLast{0};
+
+    /** Builds a new job and sends it to all miners, dropping the older ones if fClean */
+    void UpdateJob(bool fClean);
+
+    std::shared_ptr<Job> CreateJob();
+
+    void SendJob(Client &client, const Job &job, bool fClean);
+
+    void Send(Client &client, const UniValue &msg);
+
+    void Reply(Client &client, const UniValue &id, const UniValue &result, int nErrorCode = 0,
+               const std::string &strError = "");
+
+    void HandleLine(Client &client, const std::string &line);
+
+    /** Checks a mining.submit, fills strError and returns its error code, 0 if the share was accepted */
+    int SubmitShare(Client &client, const UniValue &params, std::string &strError);
+
+    void Disconnect(Client &client);
+
+    static void AcceptCallback(struct evconnlistener *listener, evutil_socket_t fd, struct sockaddr *addr, int socklen,
+                               void *ctx);
+
+    static void ReadCallback(struct bufferevent *bev, void *ctx);
+
+    static void EventCallback(struct bufferevent *bev, short what, void *ctx);
+
+    static void JobTimerCallback(evutil_socket_t fd, short what, void *ctx);
+};
+
+/** Starts the work server if -stratum is set, returns false on errors which should abort startup */
+bool StartStratum(NodeContext &node);
+
+void InterruptStratum();
+
+void StopStratum();
+
+#endif // BITCOIN_STRATUM_H
@@ -0,0 +1,206 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Copyright (c) 2025 The 405Coin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_SUPPORT_ALLOCATORS_POOL_H
+#define BITCOIN_SUPPORT_ALLOCATORS_POOL_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * A memory resource similar to std::pmr::unsynchronized_pool_resource, but optimized for node-based containers.
+ *
+ * Memory is carved out of large chunks, one free list per size class (multiples of ELEM_ALIGN_BYTES up to
+ * MAX_BLOCK_SIZE_BYTES) keeps track of blocks that were given back. Node-based containers like std::unordered_map
+ * allocate one small node per element, serving them from the chunks avoids the per-allocation malloc overhead and
+ * the heap fragmentation this causes. Allocations which are too large or need more alignment than ELEM_ALIGN_BYTES
+ * (e.g. the bucket array) are forwarded to ::operator new.
+ *
+ * Chunks are only given back to the system when the resource is destroyed, but freed blocks are reused before any
+ * new chunk is requested. The resource is not thread safe.
+ */
+template<std::size_t MAX_BLOCK_SIZE_BYTES, std::size_t ALIGN_BYTES>
+class PoolResource final {
+    static_assert(ALIGN_BYTES > 0, "ALIGN_BYTES must be nonzero");
+    static_assert((ALIGN_BYTES & (ALIGN_BYTES - 1)) == 0, "ALIGN_BYTES must be a power of two");
+
+    /** In-place linked list of the free blocks of one size class */
+    struct ListNode {
+        ListNode *m_next;
+
+        explicit ListNode(ListNode *next) : m_next(next) {}
+    };
+
+    static_assert(std::is_trivially_destructible<ListNode>::value, "Make sure we don't need to manually call a destructor");
+
+    /** Internal alignment value, large enough to hold a ListNode in every block */
+    static constexpr std::size_t ELEM_ALIGN_BYTES = std::max(alignof(ListNode), ALIGN_BYTES);
+    static_assert((ELEM_ALIGN_BYTES & (ELEM_ALIGN_BYTES - 1)) == 0, "ELEM_ALIGN_BYTES must be a power of two");
+    static_assert(sizeof(ListNode) <= ELEM_ALIGN_BYTES, "Units of size ELEM_SIZE_ALIGN need to be able to store a ListNode");
+    static_assert((MAX_BLOCK_SIZE_BYTES & (ELEM_ALIGN_BYTES - 1)) == 0, "MAX_BLOCK_SIZE_BYTES needs to be a multiple of the alignment.");
+
+    const std::size_t m_chunk_size_bytes;
+
+    std::list<std::byte *> m_allocated_chunks{};
+
+    /** Free lists, indexed by the number of ELEM_ALIGN_BYTES units of the blocks they hold */
+    std::array<ListNode *, MAX_BLOCK_SIZE_BYTES / ELEM_ALIGN_BYTES + 1> m_free_lists{};
+
+    /** Untouched memory at the end of the current chunk */
+    std::byte *m_available_memory_it = nullptr;
+    std::byte *m_available_memory_end = nullptr;
+
+    /** Bytes of the chunks currently handed out (i.e. neither untouched nor in a free list) */
+    std::size_t m_used_bytes = 0;
+
+    /** Number of ELEM_ALIGN_BYTES units needed for the given number of bytes, at least 1 */
+    static constexpr std::size_t NumElemAlignBytes(std::size_t bytes) {
+        return (bytes + ELEM_ALIGN_BYTES - 1) / ELEM_ALIGN_BYTES + (bytes == 0);
+    }
+
+    static constexpr bool IsFreeListUsable(std::size_t bytes, std::size_t alignment) {
+        return alignment <= ELEM_ALIGN_BYTES && bytes <= MAX_BLOCK_SIZE_BYTES;
+    }
+
+    void PlacementAddToList(void *p, ListNode *&node) {
+        node = new(p) ListNode{node};
+    }
+
+    /** Start a new chunk, the unused tail of the current one goes into the matching free list */
+    void AllocateChunk() {
+        const std::size_t remaining_available_bytes = m_available_memory_end - m_available_memory_it;
+        if (remaining_available_bytes != 0) {
+            PlacementAddToList(m_available_memory_it, m_free_lists[remaining_available_bytes / ELEM_ALIGN_BYTES]);
+        }
+
+        void *storage = ::operator new(m_chunk_size_bytes, std::align_val_t{ELEM_ALIGN_BYTES});
+        m_available_memory_it = new(storage) std::byte[m_chunk_size_bytes];
+        m_available_memory_end = m_available_memory_it + m_chunk_size_bytes;
+        m_allocated_chunks.emplace_back(m_available_memory_it);
+    }
+
+public:
+    /**
+     * @param[in] chunk_size_bytes  Size of the chunks memory is requested in from the system, rounded up to
+     *                              ELEM_ALIGN_BYTES. Must be at least MAX_BLOCK_SIZE_BYTES.
+     */
+    explicit PoolResource(std::size_t chunk_size_bytes)
+            : m_chunk_size_bytes(NumElemAlignBytes(chunk_size_bytes) * ELEM_ALIGN_BYTES) {
+        assert(m_chunk_size_bytes >= MAX_BLOCK_SIZE_BYTES);
+        AllocateChunk();
+    }
+
+    /** Uses 256 KiB chunks */
+    PoolResource() : PoolResource(262144) {}
+
+    PoolResource(const PoolResource &) = delete;
+
+    PoolResource &operator=(const PoolResource &) = delete;
+
+    PoolResource(PoolResource &&) = delete;
+
+    PoolResource &operator=(PoolResource &&) = delete;
+
+    /** Gives all chunks back to the system, whether the memory in them is still in use or not */
+    ~PoolResource() {
+        for (std::byte *chunk: m_allocated_chunks) {
+            ::operator delete(static_cast<void *>(chunk), std::align_val_t{ELEM_ALIGN_BYTES});
+        }
+    }
+
+    void *Allocate(std::size_t bytes, std::size_t alignment) {
+        if (IsFreeListUsable(bytes, alignment)) {
+            const std::size_t num_alignments = NumElemAlignBytes(bytes);
+            m_used_bytes += num_alignments * ELEM_ALIGN_BYTES;
+            if (m_free_lists[num_alignments] != nullptr) {
+                // Reuse a previously freed block of the same size class
+                return std::exchange(m_free_lists[num_alignments], m_free_lists[num_alignments]->m_next);
+            }
+
+            const std::size_t round_bytes = num_alignments * ELEM_ALIGN_BYTES;
+            if (round_bytes > static_cast<std::size_t>(m_available_memory_end - m_available_memory_it)) {
+                AllocateChunk();
+            }
+            return std::exchange(m_available_memory_it, m_available_memory_it + round_bytes);
+        }
+
+        return ::operator new(bytes, std::align_val_t{alignment});
+    }
+
+    void Deallocate(void *p, std::size_t bytes, std::size_t alignment) noexcept {
+        if (IsFreeListUsable(bytes, alignment)) {
+            const std::size_t num_alignments = NumElemAlignBytes(bytes);
+            m_used_bytes -= num_alignments * ELEM_ALIGN_BYTES;
+            PlacementAddToList(p, m_free_lists[num_alignments]);
+        } else {
+            ::operator delete(p, std::align_val_t{alignment});
+        }
+    }
+
+    std::size_t NumAllocatedChunks() const { return m_allocated_chunks.size(); }
+
+    std::size_t ChunkSizeBytes() const { return m_chunk_size_bytes; }
+
+    std::size_t UsedBytes() const { return m_used_bytes; }
+};
+
+/** Standard allocator which serves its memory from a PoolResource. The resource must outlive the container. */
+template<class T, std::size_t MAX_BLOCK_SIZE_BYTES, std::size_t ALIGN_BYTES = alignof(T)>
+class PoolAllocator {
+    PoolResource<MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES> *m_resource;
+
+    template<typename U, std::size_t M, std::size_t A>
+    friend class PoolAllocator;
+
+public:
+    using value_type = T;
+    using ResourceType = PoolResource<MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>;
+
+    PoolAllocator(ResourceType *resource) noexcept : m_resource(resource) {}
+
+    PoolAllocator(const PoolAllocator &other) noexcept = default;
+
+    PoolAllocator &operator=(const PoolAllocator &other) noexcept = default;
+
+    template<class U>
+    PoolAllocator(const PoolAllocator<U, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES> &other) noexcept
+            : m_resource(other.resource()) {}
+
+    template<typename U>
+    struct rebind {
+        using other = PoolAllocator<U, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>;
+    };
+
+    T *allocate(std::size_t n) {
+        return static_cast<T *>(m_resource->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept {
+        m_resource->Deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    ResourceType *resource() const noexcept { return m_resource; }
+};
+
+template<class T1, class T2, std::size_t MAX_BLOCK_SIZE_BYTES, std::size_t ALIGN_BYTES>
+bool operator==(const PoolAllocator<T1, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES> &a,
+                const PoolAllocator<T2, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES> &b) noexcept {
+    return a.resource() == b.resource();
+}
+
+template<class T1, class T2, std::size_t MAX_BLOCK_SIZE_BYTES, std::size_t ALIGN_BYTES>
+bool operator!=(const PoolAllocator<T1, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES> &a,
+                const PoolAllocator<T2, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES> &b) noexcept {
+    return !(a == b);
+}
+
+#endif // BITCOIN_SUPPORT_ALLOCATORS_POOL_H